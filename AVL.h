@@ -1,10 +1,28 @@
 #ifndef AVL_H
 #define AVL_H
+#include <algorithm>
+#include <functional>
 #include <iostream>
 #include <queue>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "FrozenIndex.h"
+#include "NodePool.h"
+#include "TreeCompare.h"
+#include "TreePrefetch.h"
+#include "TreeStats.h"
 using namespace std;
 
-template <typename T>
+// Compare: orden de las claves (std::less<T> por defecto; con claves que tienen
+// operator<=> cada nivel hace una sola comparación de tres vías)
+// Pool: política de reserva de nodos (slab_pool por defecto, heap_pool para un
+// new/delete por nodo; ver NodePool.h)
+// Stats: instrumentación de rotaciones y descensos (tree_no_stats, sin coste, o
+// tree_stats; ver TreeStats.h)
+template <typename T, typename Compare = std::less<T>, template<typename> class Pool = slab_pool,
+          typename Stats = tree_no_stats>
 class AVL {
     class node {
     public:
@@ -12,8 +30,18 @@ class AVL {
         node* left;
         node* right;
         int height;
+
+        explicit node(const T& value) : data(value), left(NULL), right(NULL), height(1) {}
     };
+    // Altura máxima de un AVL: 1.44 log2(n + 2), menos de 128 para cualquier n
+    static constexpr size_t max_height = 128;
+
     node* root = NULL;
+    node* leftmost = NULL;  // mínimo cacheado: inserciones por el borde izquierdo
+    node* rightmost = NULL; // máximo cacheado: inserciones en orden creciente
+    Pool<node> pool;
+    [[no_unique_address]] Compare comp;
+    [[no_unique_address]] Stats counters;
 
     // devuelve máximo (inorder predecessor) de un subárbol dado
     T maxUtility(node* current)
@@ -27,7 +55,20 @@ class AVL {
         return current->height;
     }
 
+    int balance_factor(node* current) {
+        return height(current->left) - height(current->right);
+    }
+
+    // Complejidad: O(n) - destruye los nodos del subárbol uno a uno
+    void destroy_subtree(node* current) {
+        if (current == NULL) return;
+        destroy_subtree(current->left);
+        destroy_subtree(current->right);
+        pool.destroy(current);
+    }
+
     node* rightRotation(node* current) {
+        counters.rotation();
         node* new_node = current->left;
         current->left = new_node->right;
         new_node->right = current;
@@ -37,6 +78,7 @@ class AVL {
     }
 
     node* leftRotation(node* current) {
+        counters.rotation();
         node* new_node = current->right;
         current->right = new_node->left;
         new_node->left = current;
@@ -52,6 +94,13 @@ class AVL {
         inOrderUtility(current->right);
     }
 
+    void collectUtility(node* current, vector<T>& out) const {
+        if (current == NULL) return;
+        collectUtility(current->left, out);
+        out.push_back(current->data);
+        collectUtility(current->right, out);
+    }
+
     void preOrderUtility(node* current) {
         if (current == NULL) return;
         cout << current->data << " ";
@@ -66,30 +115,29 @@ class AVL {
         cout << current->data << " ";
     }
 
-    node* insertUtility(node* current, T value) {
+    // depth: nodos visitados antes de current (para la instrumentación)
+    node* insertUtility(node* current, const T& value, size_t depth = 0) {
         if (current == NULL) {
-            node* new_node = new node;
-            new_node->data = value;
-            new_node->right = NULL;
-            new_node->left = NULL;
-            new_node->height = 1;
-            return new_node;
-        }
-        if (value < current->data) current->left = insertUtility(current->left, value);
-        else if (value > current->data) current->right = insertUtility(current->right, value);
+            counters.search_path(depth);
+            return pool.create(value);
+        }
+        auto c = tree_compare(comp, value, current->data);
+        if (c < 0) current->left = insertUtility(current->left, value, depth + 1);
+        else if (c > 0) current->right = insertUtility(current->right, value, depth + 1);
         // si value == current->data no insertamos (evitar duplicados)
+        else counters.search_path(depth + 1);
         current->height = 1 + max(height(current->left), height(current->right));
         int balance = height(current->left) - height(current->right);
 
         if (balance > 1) {
-            if (value > current->left->data) {
+            if (comp(current->left->data, value)) {
                 current->left = leftRotation(current->left);
                 return rightRotation(current);
             } else {
                 return rightRotation(current);
             }
         } else if (balance < -1) {
-            if (value < current->right->data) {
+            if (comp(value, current->right->data)) {
                 current->right = rightRotation(current->right);
                 return leftRotation(current);
             } else {
@@ -99,30 +147,37 @@ class AVL {
         return current;
     }
 
-    node* removeUtility(node* current, T value) {
+    // depth: nodos visitados antes de current. El descenso se cuenta al terminar:
+    // al no encontrar la clave o al desenlazar el nodo (tras bajar hasta el predecesor
+    // si tenía dos hijos)
+    node* removeUtility(node* current, const T& value, size_t depth = 0) {
         if (current == NULL) {
             // nothing to do
+            counters.search_path(depth);
             return NULL;
         }
 
-        if (value < current->data) {
-            current->left = removeUtility(current->left, value);
-        } else if (value > current->data) {
-            current->right = removeUtility(current->right, value);
+        auto c = tree_compare(comp, value, current->data);
+        if (c < 0) {
+            current->left = removeUtility(current->left, value, depth + 1);
+        } else if (c > 0) {
+            current->right = removeUtility(current->right, value, depth + 1);
         } else {
             // found node to remove
             if (current->left == NULL && current->right == NULL) {
-                delete current;
+                counters.search_path(depth + 1);
+                pool.destroy(current);
                 return NULL; // important: return immediately
             } else if (current->left != NULL && current->right != NULL) {
                 T mx = maxUtility(current->left);
                 current->data = mx;
                 // IMPORTANT: reasignar el subárbol izquierdo con el resultado de la eliminación
-                current->left = removeUtility(current->left, mx);
+                current->left = removeUtility(current->left, mx, depth + 1);
             } else {
                 // uno solo hijo
                 node* child = (current->right != NULL) ? current->right : current->left;
-                delete current;
+                counters.search_path(depth + 1);
+                pool.destroy(current);
                 return child; // el hijo toma el lugar del actual
             }
         }
@@ -131,16 +186,16 @@ class AVL {
         current->height = 1 + max(height(current->left), height(current->right));
         int balance = height(current->left) - height(current->right);
 
-        // Rebalanceo
+        // Rebalanceo: la rotación simple o doble depende del balance del hijo alto
         if (balance > 1) {
-            if (height(current->left) >= height(current->right)) {
+            if (balance_factor(current->left) >= 0) {
                 return rightRotation(current);
             } else {
                 current->left = leftRotation(current->left);
                 return rightRotation(current);
             }
         } else if (balance < -1) {
-            if (height(current->right) >= height(current->left)) {
+            if (balance_factor(current->right) <= 0) {
                 return leftRotation(current);
             } else {
                 current->right = rightRotation(current->right);
@@ -150,6 +205,146 @@ class AVL {
         return current;
     }
 
+    // Complejidad: O(1) - rebalancea el subárbol que cuelga de *link si está
+    // desequilibrado (rotación simple o doble según el balance del hijo alto)
+    void rebalance(node** link) {
+        node* current = *link;
+        int balance = balance_factor(current);
+        if (balance > 1) {
+            if (balance_factor(current->left) < 0) current->left = leftRotation(current->left);
+            *link = rightRotation(current);
+        } else if (balance < -1) {
+            if (balance_factor(current->right) > 0) current->right = rightRotation(current->right);
+            *link = leftRotation(current);
+        }
+    }
+
+    // Complejidad: O(log n) - inserción sin recursión. El descenso guarda en link[]
+    // el enlace que apunta a cada nodo del camino (&root o el campo left/right del
+    // padre), así una rotación reengancha el subárbol sin buscar al padre. La subida
+    // termina en el primer nodo cuya altura no cambia o tras la primera rotación, que
+    // devuelve al subárbol su altura anterior.
+    void insert_iterative(const T& value) {
+        node** link[max_height];
+        size_t depth = 0;
+        node** cur = &root;
+        while (*cur != NULL) {
+            link[depth++] = cur;
+            auto c = tree_compare(comp, value, (*cur)->data);
+            if (c == 0) {
+                counters.search_path(depth); // ya estaba: no se insertan duplicados
+                return;
+            }
+            cur = c < 0 ? &(*cur)->left : &(*cur)->right;
+        }
+        counters.search_path(depth);
+        *cur = pool.create(value);
+        if (leftmost == NULL) leftmost = rightmost = root;
+        for (size_t i = depth; i-- > 0;) {
+            node* current = *link[i];
+            int h = 1 + max(height(current->left), height(current->right));
+            if (h == current->height) break;
+            current->height = h;
+            int balance = balance_factor(current);
+            if (balance > 1 || balance < -1) {
+                rebalance(link[i]);
+                break;
+            }
+        }
+    }
+
+    // Complejidad: O(log n) - borrado sin recursión. Con dos hijos el descenso sigue
+    // hasta el predecesor (cuyos enlaces también van a link[]), le pasa su clave al
+    // nodo y desengancha el predecesor. La subida rebalancea y termina en el primer
+    // nodo cuyo subárbol conserva la altura; a diferencia de la inserción, un borrado
+    // puede necesitar una rotación en cada nivel.
+    void remove_iterative(const T& value) {
+        node** link[max_height];
+        size_t depth = 0;
+        node** cur = &root;
+        while (*cur != NULL) {
+            auto c = tree_compare(comp, value, (*cur)->data);
+            if (c == 0) break;
+            link[depth++] = cur;
+            cur = c < 0 ? &(*cur)->left : &(*cur)->right;
+        }
+        if (*cur == NULL) {
+            counters.search_path(depth);
+            return;
+        }
+        node* target = *cur;
+        link[depth++] = cur;
+        if (target->left != NULL && target->right != NULL) {
+            cur = &target->left;
+            link[depth++] = cur;
+            while ((*cur)->right != NULL) {
+                cur = &(*cur)->right;
+                link[depth++] = cur;
+            }
+            node* pred = *cur;
+            target->data = std::move(pred->data);
+            target = pred;
+        }
+        counters.search_path(depth);
+        // target tiene como mucho un hijo, que ocupa su lugar
+        *cur = target->left != NULL ? target->left : target->right;
+        bool was_extreme = target == leftmost || target == rightmost;
+        pool.destroy(target);
+        if (was_extreme) refresh_extremes();
+        --depth; // link[depth] apunta ya al hijo, que no cambia
+        for (size_t i = depth; i-- > 0;) {
+            node* current = *link[i];
+            int old_height = current->height;
+            current->height = 1 + max(height(current->left), height(current->right));
+            rebalance(link[i]);
+            if ((*link[i])->height == old_height) break;
+        }
+    }
+
+    // Complejidad: O(log n) punteros sin comparaciones + rebalanceo O(1) amortizado.
+    // Inserta value, menor que el mínimo (at_right = false) o mayor que el máximo
+    // (at_right = true), como hijo del extremo: baja por el borde sin comparar (son
+    // nodos que siguen en caché de la inserción anterior) y sube recalculando alturas
+    // solo hasta el primer nodo cuya altura no cambia. Por el borde el desequilibrio
+    // siempre es del mismo lado, así que basta una rotación simple, que además
+    // devuelve al subárbol su altura anterior.
+    void insert_at_edge(const T& value, bool at_right) {
+        node* path[max_height];
+        size_t depth = 0;
+        for (node* x = root; x != NULL; x = at_right ? x->right : x->left) path[depth++] = x;
+        counters.search_path(depth);
+        node* new_node = pool.create(value);
+        if (at_right) {
+            path[depth - 1]->right = new_node;
+            rightmost = new_node;
+        } else {
+            path[depth - 1]->left = new_node;
+            leftmost = new_node;
+        }
+        for (size_t i = depth; i-- > 0;) {
+            node* current = path[i];
+            int h = 1 + max(height(current->left), height(current->right));
+            if (h == current->height) break;
+            current->height = h;
+            int balance = height(current->left) - height(current->right);
+            if (balance > 1 || balance < -1) {
+                node* top = at_right ? leftRotation(current) : rightRotation(current);
+                if (i == 0) root = top;
+                else if (at_right) path[i - 1]->right = top;
+                else path[i - 1]->left = top;
+                break;
+            }
+        }
+    }
+
+    // Complejidad: O(log n) - vuelve a buscar los extremos cacheados
+    void refresh_extremes() {
+        leftmost = rightmost = root;
+        if (root == NULL) return;
+        while (leftmost->left != NULL) leftmost = leftmost->left;
+        while (rightmost->right != NULL) rightmost = rightmost->right;
+    }
+
     void display_BFS() {
         if (root == NULL) cout << "Tree is empty" << endl;
         else {
@@ -167,20 +362,144 @@ class AVL {
         }
     }
 public:
-    void insert(T value) {
+    static constexpr size_t node_bytes = sizeof(node);
+
+    AVL() = default;
+    AVL(const AVL&) = delete;
+    AVL& operator=(const AVL&) = delete;
+
+    // Complejidad: O(1) - el pool cambia de dueño con sus nodos; other queda vacío
+    AVL(AVL&& other) noexcept
+        : root(other.root), leftmost(other.leftmost), rightmost(other.rightmost),
+          pool(std::move(other.pool)), comp(std::move(other.comp)) {
+        other.root = other.leftmost = other.rightmost = NULL;
+    }
+    // Complejidad: la de clear() más O(1)
+    AVL& operator=(AVL&& other) noexcept {
+        if (this != &other) {
+            clear();
+            root = other.root;
+            leftmost = other.leftmost;
+            rightmost = other.rightmost;
+            pool = std::move(other.pool);
+            comp = std::move(other.comp);
+            other.root = other.leftmost = other.rightmost = NULL;
+        }
+        return *this;
+    }
+
+    // Complejidad: O(#slabs) con slab_pool y claves trivialmente destructibles,
+    // O(n) en otro caso (hay que destruir cada nodo)
+    ~AVL() {
+        clear();
+    }
+
+    // Complejidad: igual que el destructor
+    void clear() {
+        if constexpr (!(Pool<node>::bulk_release && std::is_trivially_destructible_v<node>))
+            destroy_subtree(root);
+        pool.release();
+        root = leftmost = rightmost = NULL;
+    }
+
+    // Una clave mayor que el máximo o menor que el mínimo entra por insert_at_edge
+    // (claves que llegan casi en orden, como marcas de tiempo); el resto, por el
+    // descenso iterativo, que nunca crea un nuevo extremo
+    void insert(const T& value) {
+        if (root != NULL && comp(rightmost->data, value)) {
+            insert_at_edge(value, true);
+        } else if (root != NULL && comp(value, leftmost->data)) {
+            insert_at_edge(value, false);
+        } else {
+            insert_iterative(value);
+        }
+    }
+    // Los extremos solo se recalculan si el nodo liberado era uno de ellos
+    void remove(const T& value) {
+        remove_iterative(value);
+    }
+    // Versiones recursivas originales (insertUtility/removeUtility), para comparar
+    // en el benchmark. Rebalancean hasta la raíz en cada operación.
+    void insert_recursive(const T& value) {
+        bool new_extreme = root == NULL || comp(value, leftmost->data) || comp(rightmost->data, value);
         root = insertUtility(root, value);
+        if (new_extreme) refresh_extremes();
     }
-    void remove(T value) {
+    // El nodo liberado puede ser un extremo aunque value no lo sea (con dos hijos se
+    // borra el predecesor), así que los extremos se recalculan tras cada borrado
+    void remove_recursive(const T& value) {
         root = removeUtility(root, value);
+        refresh_extremes();
     }
-    bool find(T value) {
+    bool find(const T& value) {
         node* current = root;
+        size_t depth = 0;
         while (current != NULL) {
-            if (value == current->data) return true;
-            else if (value < current->data) current = current->left;
+            ++depth;
+            auto c = tree_compare(comp, value, current->data);
+            if (c == 0) break;
+            else if (c < 0) current = current->left;
             else current = current->right;
         }
-        return false;
+        counters.search_path(depth);
+        return current != NULL;
+    }
+    // Búsqueda por lotes con prefetch: out[i] = find(keys[i]).
+    // Avanza tree_find_group descensos a la vez y pide por adelantado el siguiente
+    // nodo de cada uno, de modo que sus fallos de caché se solapan.
+    void find_many(span<const T> keys, span<bool> out) const {
+        if (out.size() < keys.size())
+            throw invalid_argument("find_many: out es más corto que keys");
+        node* current[tree_find_group];
+        for (size_t base = 0; base < keys.size(); base += tree_find_group) {
+            size_t group = min(tree_find_group, keys.size() - base);
+            for (size_t i = 0; i < group; ++i) {
+                current[i] = root;
+                out[base + i] = false;
+            }
+            size_t active = root != NULL ? group : 0;
+            while (active > 0) {
+                active = 0;
+                for (size_t i = 0; i < group; ++i) {
+                    node* x = current[i];
+                    if (x == NULL) continue;
+                    auto c = tree_compare(comp, keys[base + i], x->data);
+                    if (c == 0) {
+                        out[base + i] = true;
+                        current[i] = NULL;
+                        continue;
+                    }
+                    x = c < 0 ? x->left : x->right;
+                    current[i] = x;
+                    if (x != NULL) {
+                        tree_prefetch(x);
+                        ++active;
+                    }
+                }
+            }
+        }
+    }
+    // Índice inmutable y contiguo con las claves actuales (ver FrozenIndex.h):
+    // FrozenIndex por defecto, o FrozenBlockIndex<T> con claves enteras
+    template<typename Index = FrozenIndex<T, Compare>>
+    Index freeze() const {
+        vector<T> keys;
+        collectUtility(root, keys);
+        return Index(keys.begin(), keys.end(), comp);
+    }
+    // Memoria reservada por el pool (0 si el pool no lleva la cuenta)
+    size_t reserved_bytes() const {
+        if constexpr (requires { pool.reserved_bytes(); })
+            return pool.reserved_bytes();
+        else
+            return 0;
+    }
+    // Contadores de la política Stats (ver TreeStats.h)
+    const Stats& stats() const {
+        return counters;
+    }
+    void reset_stats() {
+        counters.reset();
     }
     void inorder() {
         inOrderUtility(root);
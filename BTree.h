@@ -0,0 +1,521 @@
+#ifndef BTREE_H
+#define BTREE_H
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include "NodePool.h"
+#include "TreeCompare.h"
+#include "TreeSimd.h"
+
+// Árbol B+ en memoria con nodos de NodeBytes bytes (por defecto 256: cuatro líneas
+// de caché). Cada nodo guarda muchas claves contiguas, así que un descenso toca
+// log_B(n) nodos en lugar de log2(n): con 1e6 claves int son 4 niveles frente a
+// los ~20 de RB_tree o AVL.
+//  - Las claves viven en las hojas, enlazadas en las dos direcciones para iterar.
+//  - Los nodos internos guardan separadores: keys[i] >= toda clave del hijo i y
+//    < toda clave del hijo i + 1, así que se baja al hijo "número de separadores
+//    < key", la misma cuenta que en las hojas da la posición de la clave.
+//  - Con claves enteras de 4 u 8 bytes y std::less esa cuenta es simd_rank
+//    (TreeSimd.h) sobre el nodo entero, sin ramas; los huecos valen el máximo de T.
+//    Con cualquier otra clave o comparador, búsqueda binaria dentro del nodo.
+// Sin duplicados (como AVL y Splay). T debe poder construirse por defecto: los
+// nodos reservan sus arreglos de claves completos. Insertar o borrar invalida los
+// iteradores (las claves se desplazan dentro del nodo y entre nodos).
+template<typename T, typename Compare = std::less<T>, std::size_t NodeBytes = 256>
+class BTree {
+    static_assert(NodeBytes >= 64, "BTree: al menos una línea de caché por nodo");
+
+private:
+    static constexpr bool simd_search = simd_rank_key<T> && is_default_less<Compare>;
+    // Las capacidades se redondean a registros SIMD completos
+    static constexpr std::size_t lane = simd_search ? simd_rank_lane<T> : 1;
+
+    static constexpr std::size_t round_capacity(std::size_t n, std::size_t min) {
+        n = n / lane * lane;
+        return n < min ? (min + lane - 1) / lane * lane : n;
+    }
+
+public:
+    // Claves por hoja (además: prev, next y count) y por nodo interno (más sus hijos)
+    static constexpr std::size_t leaf_capacity =
+        round_capacity((NodeBytes - 2 * sizeof(void*) - sizeof(std::uint32_t)) / sizeof(T), 2);
+    static constexpr std::size_t inner_capacity =
+        round_capacity((NodeBytes - sizeof(void*) - sizeof(std::uint32_t)) / (sizeof(T) + sizeof(void*)), 3);
+
+private:
+    // Por debajo de este número de claves un nodo (que no sea la raíz) pide
+    // prestada una clave a un hermano o se fusiona con él
+    static constexpr std::size_t min_leaf = leaf_capacity / 2;
+    static constexpr std::size_t min_inner = inner_capacity / 2;
+    // Cada nodo interno que no es la raíz tiene al menos 2 hijos
+    static constexpr std::size_t max_height = 64;
+
+    struct alignas(64) leaf_node {
+        T keys[leaf_capacity];
+        leaf_node* prev = nullptr;
+        leaf_node* next = nullptr;
+        std::uint32_t count = 0;
+
+        leaf_node() { std::fill(keys, keys + leaf_capacity, empty_key()); }
+    };
+
+    struct alignas(64) inner_node {
+        T keys[inner_capacity];
+        void* children[inner_capacity + 1];
+        std::uint32_t count = 0;
+
+        inner_node() { std::fill(keys, keys + inner_capacity, empty_key()); }
+    };
+
+    // Los hijos se guardan como void*: la altura dice si son hojas o nodos internos
+    void* root = nullptr;
+    std::size_t height = 0; // niveles de nodos internos sobre las hojas
+    leaf_node* first_leaf = nullptr;
+    leaf_node* last_leaf = nullptr;
+    std::size_t node_count = 0; // claves
+    [[no_unique_address]] Compare comp;
+    slab_pool<leaf_node> leaves;
+    slab_pool<inner_node> inners;
+
+    static leaf_node* as_leaf(void* p) { return static_cast<leaf_node*>(p); }
+    static inner_node* as_inner(void* p) { return static_cast<inner_node*>(p); }
+
+    // Valor de los huecos: el máximo con búsqueda SIMD (nunca cuenta como < key);
+    // si no, T() para no retener copias de claves ya borradas
+    static T empty_key() {
+        if constexpr (simd_search)
+            return std::numeric_limits<T>::max();
+        else
+            return T();
+    }
+
+    // Complejidad: O(Cap) sin ramas con SIMD, O(log Cap) si no - número de claves < key
+    template<std::size_t Cap>
+    std::size_t rank(const T* keys, std::size_t n, const T& key) const {
+        if constexpr (simd_search)
+            return simd_rank<Cap>(keys, key);
+        else
+            return static_cast<std::size_t>(std::lower_bound(keys, keys + n, key, comp) - keys);
+    }
+
+    // Complejidad: O(altura) - hoja donde está o iría key
+    const leaf_node* find_leaf(const T& key) const {
+        void* n = root;
+        for (std::size_t level = 0; level < height; ++level) {
+            const inner_node* in = as_inner(n);
+            n = in->children[rank<inner_capacity>(in->keys, in->count, key)];
+        }
+        return as_leaf(n);
+    }
+
+    // Complejidad: O(B)
+    static void insert_key(T* keys, std::size_t n, std::size_t pos, const T& key) {
+        std::move_backward(keys + pos, keys + n, keys + n + 1);
+        keys[pos] = key;
+    }
+    static void erase_key(T* keys, std::size_t n, std::size_t pos) {
+        std::move(keys + pos + 1, keys + n, keys + pos);
+        keys[n - 1] = empty_key();
+    }
+    static void insert_child(void** children, std::size_t n, std::size_t pos, void* child) {
+        std::move_backward(children + pos, children + n, children + n + 1);
+        children[pos] = child;
+    }
+    static void erase_child(void** children, std::size_t n, std::size_t pos) {
+        std::move(children + pos + 1, children + n, children + pos);
+    }
+
+    // Complejidad: O(B) - pasa la mitad alta de la hoja llena a una hoja nueva a su derecha
+    leaf_node* split_leaf(leaf_node* leaf) {
+        leaf_node* right = leaves.create();
+        std::size_t keep = leaf_capacity / 2;
+        std::move(leaf->keys + keep, leaf->keys + leaf_capacity, right->keys);
+        std::fill(leaf->keys + keep, leaf->keys + leaf_capacity, empty_key());
+        right->count = static_cast<std::uint32_t>(leaf_capacity - keep);
+        leaf->count = static_cast<std::uint32_t>(keep);
+
+        right->prev = leaf;
+        right->next = leaf->next;
+        if (leaf->next != nullptr) leaf->next->prev = right;
+        else last_leaf = right;
+        leaf->next = right;
+        return right;
+    }
+
+    // Complejidad: O(B) - inserta (sep, child) en la posición pos del nodo lleno in
+    // y lo parte en dos. Devuelve el separador que sube al padre y el nodo derecho.
+    std::pair<T, inner_node*> split_inner(inner_node* in, std::size_t pos, const T& sep, void* child) {
+        T keys[inner_capacity + 1];
+        void* children[inner_capacity + 2];
+        std::move(in->keys, in->keys + pos, keys);
+        keys[pos] = sep;
+        std::move(in->keys + pos, in->keys + inner_capacity, keys + pos + 1);
+        std::copy(in->children, in->children + pos + 1, children);
+        children[pos + 1] = child;
+        std::copy(in->children + pos + 1, in->children + inner_capacity + 1, children + pos + 2);
+
+        const std::size_t m = (inner_capacity + 1) / 2;
+        inner_node* right = inners.create();
+        std::move(keys, keys + m, in->keys);
+        std::fill(in->keys + m, in->keys + inner_capacity, empty_key());
+        std::copy(children, children + m + 1, in->children);
+        in->count = static_cast<std::uint32_t>(m);
+
+        std::move(keys + m + 1, keys + inner_capacity + 1, right->keys);
+        std::copy(children + m + 1, children + inner_capacity + 2, right->children);
+        right->count = static_cast<std::uint32_t>(inner_capacity - m);
+        return {std::move(keys[m]), right};
+    }
+
+    // Complejidad: O(B) - hoja con menos de min_leaf claves: toma una de un hermano
+    // o se fusiona con él. true si hubo fusión (el padre perdió un separador)
+    bool fix_leaf(leaf_node* leaf, inner_node* parent, std::size_t i) {
+        if (i > 0) {
+            leaf_node* left = as_leaf(parent->children[i - 1]);
+            if (left->count > min_leaf) {
+                insert_key(leaf->keys, leaf->count, 0, left->keys[left->count - 1]);
+                ++leaf->count;
+                erase_key(left->keys, left->count, left->count - 1);
+                --left->count;
+                parent->keys[i - 1] = left->keys[left->count - 1];
+                return false;
+            }
+        }
+        if (i < parent->count) {
+            leaf_node* right = as_leaf(parent->children[i + 1]);
+            if (right->count > min_leaf) {
+                leaf->keys[leaf->count++] = right->keys[0];
+                erase_key(right->keys, right->count, 0);
+                --right->count;
+                parent->keys[i] = leaf->keys[leaf->count - 1];
+                return false;
+            }
+        }
+        // Ningún hermano puede prestar: se fusiona con uno (cabe: < 2 min_leaf claves)
+        std::size_t s = i > 0 ? i - 1 : i;
+        leaf_node* a = as_leaf(parent->children[s]);
+        leaf_node* b = as_leaf(parent->children[s + 1]);
+        std::move(b->keys, b->keys + b->count, a->keys + a->count);
+        a->count += b->count;
+        a->next = b->next;
+        if (b->next != nullptr) b->next->prev = a;
+        else last_leaf = a;
+        leaves.destroy(b);
+        // El separador de b (>= todas sus claves) pasa a ser el de a
+        erase_key(parent->keys, parent->count, s);
+        erase_child(parent->children, parent->count + 1, s + 1);
+        --parent->count;
+        return true;
+    }
+
+    // Complejidad: O(B) - lo mismo para un nodo interno: las claves pasan por el padre
+    bool fix_inner(inner_node* in, inner_node* parent, std::size_t i) {
+        if (i > 0) {
+            inner_node* left = as_inner(parent->children[i - 1]);
+            if (left->count > min_inner) {
+                insert_key(in->keys, in->count, 0, parent->keys[i - 1]);
+                insert_child(in->children, in->count + 1, 0, left->children[left->count]);
+                ++in->count;
+                parent->keys[i - 1] = left->keys[left->count - 1];
+                erase_key(left->keys, left->count, left->count - 1);
+                --left->count;
+                return false;
+            }
+        }
+        if (i < parent->count) {
+            inner_node* right = as_inner(parent->children[i + 1]);
+            if (right->count > min_inner) {
+                in->keys[in->count] = parent->keys[i];
+                in->children[in->count + 1] = right->children[0];
+                ++in->count;
+                parent->keys[i] = right->keys[0];
+                erase_key(right->keys, right->count, 0);
+                erase_child(right->children, right->count + 1, 0);
+                --right->count;
+                return false;
+            }
+        }
+        std::size_t s = i > 0 ? i - 1 : i;
+        inner_node* a = as_inner(parent->children[s]);
+        inner_node* b = as_inner(parent->children[s + 1]);
+        a->keys[a->count] = parent->keys[s];
+        std::move(b->keys, b->keys + b->count, a->keys + a->count + 1);
+        std::copy(b->children, b->children + b->count + 1, a->children + a->count + 1);
+        a->count += 1 + b->count;
+        inners.destroy(b);
+        erase_key(parent->keys, parent->count, s);
+        erase_child(parent->children, parent->count + 1, s + 1);
+        --parent->count;
+        return true;
+    }
+
+    // Complejidad: O(n)
+    void destroy_subtree(void* n, std::size_t level) {
+        if (level == height) {
+            leaves.destroy(as_leaf(n));
+            return;
+        }
+        inner_node* in = as_inner(n);
+        for (std::size_t i = 0; i <= in->count; ++i)
+            destroy_subtree(in->children[i], level + 1);
+        inners.destroy(in);
+    }
+
+public:
+    // Iterador bidireccional de solo lectura sobre las hojas enlazadas
+    class const_iterator {
+    private:
+        const leaf_node* leaf = nullptr; // nullptr en end()
+        std::size_t pos = 0;
+        const BTree* tree = nullptr;     // para --end()
+
+        friend class BTree;
+        const_iterator(const leaf_node* l, std::size_t p, const BTree* t) : leaf(l), pos(p), tree(t) {}
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() = default;
+
+        reference operator*() const { return leaf->keys[pos]; }
+        pointer operator->() const { return &leaf->keys[pos]; }
+
+        // Complejidad: O(1)
+        const_iterator& operator++() {
+            if (++pos == leaf->count) {
+                leaf = leaf->next;
+                pos = 0;
+            }
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+        const_iterator& operator--() {
+            if (leaf == nullptr) {
+                leaf = tree->last_leaf;
+                pos = leaf->count - 1;
+            } else if (pos == 0) {
+                leaf = leaf->prev;
+                pos = leaf->count - 1;
+            } else {
+                --pos;
+            }
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator old = *this;
+            --*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator& o) const { return leaf == o.leaf && pos == o.pos; }
+    };
+    using iterator = const_iterator;
+
+    // Complejidad: O(1)
+    BTree() = default;
+    explicit BTree(const Compare& c) : comp(c) {}
+
+    BTree(const BTree&) = delete;
+    BTree& operator=(const BTree&) = delete;
+
+    // Complejidad: O(1) - los nodos cambian de dueño junto con los pools
+    BTree(BTree&& other) noexcept
+        : root(std::exchange(other.root, nullptr)), height(std::exchange(other.height, 0)),
+          first_leaf(std::exchange(other.first_leaf, nullptr)), last_leaf(std::exchange(other.last_leaf, nullptr)),
+          node_count(std::exchange(other.node_count, 0)), comp(other.comp),
+          leaves(std::move(other.leaves)), inners(std::move(other.inners)) {}
+
+    BTree& operator=(BTree&& other) noexcept {
+        if (this != &other) {
+            clear();
+            root = std::exchange(other.root, nullptr);
+            height = std::exchange(other.height, 0);
+            first_leaf = std::exchange(other.first_leaf, nullptr);
+            last_leaf = std::exchange(other.last_leaf, nullptr);
+            node_count = std::exchange(other.node_count, 0);
+            comp = other.comp;
+            leaves = std::move(other.leaves);
+            inners = std::move(other.inners);
+        }
+        return *this;
+    }
+
+    ~BTree() {
+        clear();
+    }
+
+    // Complejidad: O(log_B n) nodos + O(B) para abrir hueco; false si la clave ya estaba
+    bool insert(const T& key) {
+        if (root == nullptr) {
+            leaf_node* leaf = leaves.create();
+            leaf->keys[0] = key;
+            leaf->count = 1;
+            root = first_leaf = last_leaf = leaf;
+            node_count = 1;
+            return true;
+        }
+
+        inner_node* path[max_height];
+        std::size_t slot[max_height];
+        void* n = root;
+        for (std::size_t level = 0; level < height; ++level) {
+            inner_node* in = as_inner(n);
+            slot[level] = rank<inner_capacity>(in->keys, in->count, key);
+            path[level] = in;
+            n = in->children[slot[level]];
+        }
+        leaf_node* leaf = as_leaf(n);
+        std::size_t pos = rank<leaf_capacity>(leaf->keys, leaf->count, key);
+        if (pos < leaf->count && !comp(key, leaf->keys[pos])) return false;
+        ++node_count;
+
+        if (leaf->count < leaf_capacity) {
+            insert_key(leaf->keys, leaf->count, pos, key);
+            ++leaf->count;
+            return true;
+        }
+
+        // Hoja llena: se parte y el máximo de la mitad izquierda sube como separador
+        leaf_node* right = split_leaf(leaf);
+        if (pos <= leaf->count) {
+            insert_key(leaf->keys, leaf->count, pos, key);
+            ++leaf->count;
+        } else {
+            insert_key(right->keys, right->count, pos - leaf->count, key);
+            ++right->count;
+        }
+        T sep = leaf->keys[leaf->count - 1];
+        void* child = right;
+
+        for (std::size_t level = height; level-- > 0;) {
+            inner_node* in = path[level];
+            std::size_t i = slot[level];
+            if (in->count < inner_capacity) {
+                insert_key(in->keys, in->count, i, sep);
+                insert_child(in->children, in->count + 1, i + 1, child);
+                ++in->count;
+                return true;
+            }
+            auto [up, new_right] = split_inner(in, i, sep, child);
+            sep = std::move(up);
+            child = new_right;
+        }
+
+        // Se partió la raíz: el árbol crece un nivel
+        inner_node* new_root = inners.create();
+        new_root->keys[0] = std::move(sep);
+        new_root->children[0] = root;
+        new_root->children[1] = child;
+        new_root->count = 1;
+        root = new_root;
+        ++height;
+        return true;
+    }
+
+    // Complejidad: O(log_B n) nodos + O(B) por nivel que se reequilibra
+    bool remove(const T& key) {
+        if (root == nullptr) return false;
+
+        inner_node* path[max_height];
+        std::size_t slot[max_height];
+        void* n = root;
+        for (std::size_t level = 0; level < height; ++level) {
+            inner_node* in = as_inner(n);
+            slot[level] = rank<inner_capacity>(in->keys, in->count, key);
+            path[level] = in;
+            n = in->children[slot[level]];
+        }
+        leaf_node* leaf = as_leaf(n);
+        std::size_t pos = rank<leaf_capacity>(leaf->keys, leaf->count, key);
+        if (pos == leaf->count || comp(key, leaf->keys[pos])) return false;
+        erase_key(leaf->keys, leaf->count, pos);
+        --leaf->count;
+        --node_count;
+
+        if (height == 0) {
+            if (leaf->count == 0) {
+                leaves.destroy(leaf);
+                root = first_leaf = last_leaf = nullptr;
+            }
+            return true;
+        }
+        if (leaf->count >= min_leaf) return true;
+
+        // Los separadores no se tocan al borrar: siguen acotando sus hijos
+        std::size_t level = height - 1;
+        if (!fix_leaf(leaf, path[level], slot[level])) return true;
+        while (level > 0 && path[level]->count < min_inner) {
+            if (!fix_inner(path[level], path[level - 1], slot[level - 1])) return true;
+            --level;
+        }
+        if (level == 0 && as_inner(root)->count == 0) {
+            // La raíz se quedó con un solo hijo: el árbol baja un nivel
+            inner_node* old = as_inner(root);
+            root = old->children[0];
+            inners.destroy(old);
+            --height;
+        }
+        return true;
+    }
+
+    // Complejidad: O(log_B n) nodos
+    bool find(const T& key) const {
+        if (root == nullptr) return false;
+        const leaf_node* leaf = find_leaf(key);
+        std::size_t pos = rank<leaf_capacity>(leaf->keys, leaf->count, key);
+        return pos < leaf->count && !comp(key, leaf->keys[pos]);
+    }
+
+    // Complejidad: O(log_B n) - primera clave >= key
+    const_iterator lower_bound(const T& key) const {
+        if (root == nullptr) return end();
+        const leaf_node* leaf = find_leaf(key);
+        std::size_t pos = rank<leaf_capacity>(leaf->keys, leaf->count, key);
+        // key es mayor que todo lo de la hoja: la primera clave de la siguiente
+        // supera al separador, que es >= key
+        if (pos == leaf->count) return const_iterator(leaf->next, 0, this);
+        return const_iterator(leaf, pos, this);
+    }
+
+    // Complejidad: O(1)
+    const_iterator begin() const {
+        return const_iterator(first_leaf, 0, this);
+    }
+    const_iterator end() const {
+        return const_iterator(nullptr, 0, this);
+    }
+
+    // Complejidad: O(n) - con claves trivialmente destructibles basta soltar los slabs
+    void clear() {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            if (root != nullptr) destroy_subtree(root, 0);
+        leaves.release();
+        inners.release();
+        root = nullptr;
+        height = 0;
+        first_leaf = last_leaf = nullptr;
+        node_count = 0;
+    }
+
+    // Complejidad: O(1)
+    std::size_t size() const {
+        return node_count;
+    }
+    bool empty() const {
+        return node_count == 0;
+    }
+};
+#endif //BTREE_H
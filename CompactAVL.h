@@ -0,0 +1,331 @@
+#ifndef COMPACT_AVL_H
+#define COMPACT_AVL_H
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include "NodePool.h"
+#include "TreeCompare.h"
+#include "TreeStats.h"
+
+// Árbol AVL con nodo compacto: en lugar de la altura, cada nodo guarda solo su factor
+// de balance (altura derecha - altura izquierda, de -1 a 1) en los 2 bits bajos del
+// puntero al hijo izquierdo. Con claves int el nodo ocupa 24 bytes frente a los 32
+// de AVL<int>, y no hay alturas que recalcular en cada nivel.
+//
+// Sin punteros al padre:
+//  - insert desciende recordando el nodo más profundo del camino con balance
+//    distinto de 0 (el único que puede desequilibrarse) y, tras colgar la hoja,
+//    actualiza los balances de arriba abajo desde ese nodo con las direcciones
+//    guardadas en el descenso; como mucho rota una vez, en ese nodo.
+//  - remove guarda el camino en una pila y sube ajustando balances solo mientras la
+//    altura del subárbol baja: un balance que pasa de 0 a ±1, o una rotación simple
+//    sobre un hijo equilibrado, dejan la altura igual y cortan la subida.
+//
+// Sin duplicados, como AVL. Mismos parámetros que AVL.
+template <typename T, typename Compare = std::less<T>, template<typename> class Pool = slab_pool,
+          typename Stats = tree_no_stats>
+class CompactAVL {
+private:
+    struct node {
+        T data;
+        // links[0]: hijo izquierdo | (balance + 1); links[1]: hijo derecho. Un arreglo
+        // para que el descenso elija el hijo con un índice (child(x, c > 0))
+        std::uintptr_t links[2];
+
+        explicit node(const T& value) : data(value), links{1, 0} {}
+    };
+    static_assert(alignof(node) >= 4, "los 2 bits bajos del puntero al hijo izquierdo deben estar libres");
+
+    // Altura máxima de un AVL: 1.44 log2(n + 2), menos de 128 para cualquier n
+    static constexpr std::size_t max_height = 128;
+    static constexpr std::uintptr_t balance_mask = 3;
+
+    node* root = nullptr;
+    std::size_t node_count = 0;
+    Pool<node> pool;
+    [[no_unique_address]] Compare comp;
+    // mutable: también cuentan los descensos de find, que es const
+    [[no_unique_address]] mutable Stats counters;
+
+    // dir: 0 izquierda, 1 derecha (los bits bajos de links[1] siempre son 0)
+    static node* child(const node* x, int dir) {
+        return reinterpret_cast<node*>(x->links[dir] & ~balance_mask);
+    }
+    static void set_child(node* x, int dir, node* y) {
+        x->links[dir] = reinterpret_cast<std::uintptr_t>(y) | (x->links[dir] & balance_mask);
+    }
+    static int balance(const node* x) {
+        return static_cast<int>(x->links[0] & balance_mask) - 1;
+    }
+    static void set_balance(node* x, int b) {
+        x->links[0] = (x->links[0] & ~balance_mask) | static_cast<std::uintptr_t>(b + 1);
+    }
+
+    // Complejidad: O(1) - sube el hijo dir de p
+    node* rotate(node* p, int dir) {
+        counters.rotation();
+        node* s = child(p, dir);
+        set_child(p, dir, child(s, 1 - dir));
+        set_child(s, 1 - dir, p);
+        return s;
+    }
+
+    // Complejidad: O(1) - p tiene balance ±2 hacia el lado dir (todavía sin escribir,
+    // no cabe en 2 bits). Rota simple o doble según el balance del hijo de ese lado y
+    // deja los balances finales. Devuelve la nueva raíz del subárbol; shrunk indica si
+    // el subárbol quedó más bajo que antes del desequilibrio (siempre, salvo la
+    // rotación simple sobre un hijo equilibrado, que solo ocurre al borrar).
+    node* rebalance(node* p, int dir, bool& shrunk) {
+        int sign = dir ? 1 : -1;
+        node* s = child(p, dir);
+        int sb = balance(s);
+        if (sb == sign) {
+            set_balance(p, 0);
+            set_balance(s, 0);
+            shrunk = true;
+            return rotate(p, dir);
+        }
+        if (sb == 0) {
+            set_balance(p, sign);
+            set_balance(s, -sign);
+            shrunk = false;
+            return rotate(p, dir);
+        }
+        node* g = child(s, 1 - dir);
+        int gb = balance(g);
+        set_child(p, dir, rotate(s, 1 - dir));
+        node* top = rotate(p, dir);
+        set_balance(p, gb == sign ? -sign : 0);
+        set_balance(s, gb == -sign ? sign : 0);
+        set_balance(g, 0);
+        shrunk = true;
+        return top;
+    }
+
+    void replace_child(node* parent, int dir, node* x) {
+        if (parent == nullptr)
+            root = x;
+        else
+            set_child(parent, dir, x);
+    }
+
+    // Complejidad: O(n) - destruye los nodos del subárbol uno a uno
+    void destroy_subtree(node* x) {
+        if (x == nullptr) return;
+        destroy_subtree(child(x, 0));
+        destroy_subtree(child(x, 1));
+        pool.destroy(x);
+    }
+
+    template<typename F>
+    void for_each_utility(const node* x, F& f) const {
+        if (x == nullptr) return;
+        for_each_utility(child(x, 0), f);
+        f(x->data);
+        for_each_utility(child(x, 1), f);
+    }
+
+public:
+    static constexpr std::size_t node_bytes = sizeof(node);
+
+    CompactAVL() = default;
+    CompactAVL(const CompactAVL&) = delete;
+    CompactAVL& operator=(const CompactAVL&) = delete;
+
+    // Complejidad: O(1) - el pool cambia de dueño con sus nodos; other queda vacío
+    CompactAVL(CompactAVL&& other) noexcept
+        : root(other.root), node_count(other.node_count), pool(std::move(other.pool)), comp(std::move(other.comp)) {
+        other.root = nullptr;
+        other.node_count = 0;
+    }
+    // Complejidad: la de clear() más O(1)
+    CompactAVL& operator=(CompactAVL&& other) noexcept {
+        if (this != &other) {
+            clear();
+            root = other.root;
+            node_count = other.node_count;
+            pool = std::move(other.pool);
+            comp = std::move(other.comp);
+            other.root = nullptr;
+            other.node_count = 0;
+        }
+        return *this;
+    }
+
+    // Complejidad: O(#slabs) con slab_pool y claves trivialmente destructibles,
+    // O(n) en otro caso (hay que destruir cada nodo)
+    ~CompactAVL() {
+        clear();
+    }
+
+    // Complejidad: igual que el destructor
+    void clear() {
+        if constexpr (!(Pool<node>::bulk_release && std::is_trivially_destructible_v<node>))
+            destroy_subtree(root);
+        pool.release();
+        root = nullptr;
+        node_count = 0;
+    }
+
+    // Complejidad: O(log n) - devuelve false si la clave ya estaba
+    bool insert(const T& value) {
+        if (root == nullptr) {
+            root = pool.create(value);
+            node_count = 1;
+            counters.search_path(0);
+            return true;
+        }
+        unsigned char dirs[max_height];
+        // safe: nodo más profundo con balance != 0 (o la raíz), con su padre y su
+        // profundidad; por debajo de él todos los balances del camino son 0
+        node* safe = root;
+        node* safe_parent = nullptr;
+        std::size_t safe_depth = 0;
+        node* x = root;
+        std::size_t depth = 0;
+        for (;;) {
+            auto c = tree_compare(comp, value, x->data);
+            if (c == 0) {
+                counters.search_path(depth + 1);
+                return false;
+            }
+            int dir = c > 0;
+            dirs[depth++] = static_cast<unsigned char>(dir);
+            node* next = child(x, dir);
+            if (next == nullptr) {
+                set_child(x, dir, pool.create(value));
+                break;
+            }
+            if (balance(next) != 0) {
+                safe = next;
+                safe_parent = x;
+                safe_depth = depth;
+            }
+            x = next;
+        }
+        counters.search_path(depth);
+        ++node_count;
+
+        // Los nodos entre safe y la hoja pasan de 0 a ±1 hacia el lado de la hoja
+        node* p = child(safe, dirs[safe_depth]);
+        for (std::size_t i = safe_depth + 1; i < depth; ++i) {
+            set_balance(p, dirs[i] ? 1 : -1);
+            p = child(p, dirs[i]);
+        }
+        int dir = dirs[safe_depth];
+        int b = balance(safe) + (dir ? 1 : -1);
+        if (b >= -1 && b <= 1) {
+            set_balance(safe, b);
+            return true;
+        }
+        bool shrunk;
+        node* top = rebalance(safe, dir, shrunk);
+        replace_child(safe_parent, safe_parent != nullptr ? dirs[safe_depth - 1] : 0, top);
+        return true;
+    }
+
+    // Complejidad: O(log n) - devuelve false si la clave no estaba. Con dos hijos la
+    // clave del predecesor pasa al nodo y se desengancha el predecesor, como en AVL.
+    bool remove(const T& value) {
+        node* path[max_height];
+        unsigned char dirs[max_height];
+        std::size_t depth = 0;
+        node* x = root;
+        while (x != nullptr) {
+            auto c = tree_compare(comp, value, x->data);
+            if (c == 0) break;
+            int dir = c > 0;
+            path[depth] = x;
+            dirs[depth++] = static_cast<unsigned char>(dir);
+            x = child(x, dir);
+        }
+        if (x == nullptr) {
+            counters.search_path(depth);
+            return false;
+        }
+        node* left = child(x, 0);
+        if (left != nullptr && child(x, 1) != nullptr) {
+            path[depth] = x;
+            dirs[depth++] = 0;
+            node* y = left;
+            while (child(y, 1) != nullptr) {
+                path[depth] = y;
+                dirs[depth++] = 1;
+                y = child(y, 1);
+            }
+            x->data = std::move(y->data);
+            x = y;
+            left = child(x, 0);
+        }
+        counters.search_path(depth + 1);
+        replace_child(depth > 0 ? path[depth - 1] : nullptr, depth > 0 ? dirs[depth - 1] : 0,
+                      left != nullptr ? left : child(x, 1));
+        pool.destroy(x);
+        --node_count;
+
+        // El subárbol del lado dirs[i] de path[i] ha bajado un nivel
+        for (std::size_t i = depth; i-- > 0;) {
+            node* p = path[i];
+            int dir = dirs[i];
+            int b = balance(p) + (dir ? -1 : 1);
+            if (b == 0) {
+                set_balance(p, 0); // estaba cargado hacia ese lado: p también baja
+                continue;
+            }
+            if (b == 1 || b == -1) {
+                set_balance(p, b); // estaba equilibrado: la altura de p no cambia
+                break;
+            }
+            bool shrunk;
+            node* top = rebalance(p, 1 - dir, shrunk);
+            replace_child(i > 0 ? path[i - 1] : nullptr, i > 0 ? dirs[i - 1] : 0, top);
+            if (!shrunk) break;
+        }
+        return true;
+    }
+
+    bool find(const T& value) const {
+        const node* x = root;
+        std::size_t depth = 0;
+        while (x != nullptr) {
+            ++depth;
+            auto c = tree_compare(comp, value, x->data);
+            if (c == 0) break;
+            x = child(x, c > 0); // el hijo se elige por índice
+        }
+        counters.search_path(depth);
+        return x != nullptr;
+    }
+
+    // Complejidad: O(n) - llama a f con cada clave en orden
+    template<typename F>
+    void for_each(F f) const {
+        for_each_utility(root, f);
+    }
+
+    std::size_t size() const {
+        return node_count;
+    }
+    bool empty() const {
+        return node_count == 0;
+    }
+
+    // Memoria reservada por el pool (0 si el pool no lleva la cuenta)
+    std::size_t reserved_bytes() const {
+        if constexpr (requires { pool.reserved_bytes(); })
+            return pool.reserved_bytes();
+        else
+            return 0;
+    }
+
+    // Contadores de la política Stats (ver TreeStats.h)
+    const Stats& stats() const {
+        return counters;
+    }
+    void reset_stats() {
+        counters.reset();
+    }
+};
+#endif //COMPACT_AVL_H
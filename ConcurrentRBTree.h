@@ -0,0 +1,201 @@
+#ifndef CONCURRENT_RB_TREE_H
+#define CONCURRENT_RB_TREE_H
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <type_traits>
+#include "RB_tree.h"
+
+// RB_tree compartido entre hilos: muchos lectores a la vez y un escritor cada vez.
+//
+// Los escritores (add_leaf, insert_unique, delete_leaf, clear, write) toman el
+// shared_mutex en exclusiva. Los lectores pueden usar una de dos políticas:
+//  - rb_shared_lock_reads: cada lectura toma el shared_mutex en modo compartido.
+//    Sencillo, pero todos los lectores escriben en la misma línea de caché del
+//    mutex y con muchos hilos eso limita la escalabilidad.
+//  - rb_optimistic_reads: find no toma ningún lock. Es un seqlock: el escritor
+//    pone la versión en impar mientras modifica el árbol y el lector repite la
+//    búsqueda si la versión cambió (o era impar) durante su descenso. Tras unos
+//    cuantos intentos fallidos cae al shared_mutex, así que un escritor continuo
+//    no deja a los lectores sin avanzar.
+//
+// La lectura optimista solo es posible si seguir un enlace desactualizado nunca
+// toca memoria liberada (pool con stable_addresses, es decir slab_pool) y si leer
+// una clave a medio escribir no puede romper nada (T trivialmente copiable). Con
+// cualquier otra combinación se usa el shared_mutex aunque se pida rb_optimistic_reads.
+// Los recorridos por rango siempre se hacen bajo el shared_mutex.
+
+struct rb_shared_lock_reads {
+    static constexpr bool optimistic = false;
+};
+
+struct rb_optimistic_reads {
+    static constexpr bool optimistic = true;
+    static constexpr int attempts = 4; // intentos sin lock antes de tomar el shared_mutex
+};
+
+template<typename T, typename Compare = std::less<T>, template<typename> class Pool = slab_pool,
+         typename Layout = rb_pointer_layout, typename Augment = rb_no_augment,
+         typename ReadPolicy = rb_optimistic_reads>
+class ConcurrentRBTree {
+public:
+    using tree_type = RB_tree<T, Compare, Pool, Layout, Augment>;
+
+    // true si find no toma ningún lock (ver comentario de cabecera)
+    static constexpr bool optimistic_reads =
+        ReadPolicy::optimistic && tree_type::layout::pool_type::stable_addresses &&
+        std::is_trivially_copyable_v<T>;
+
+private:
+    // Un RB_tree de n nodos mide como mucho 2 log2(n + 1) < 128 niveles: un descenso
+    // más largo solo puede venir de un camino a medio modificar
+    static constexpr std::size_t max_depth = 128;
+
+    mutable std::shared_mutex mutex;
+    // Versión del seqlock: impar mientras un escritor modifica el árbol.
+    // En su propia línea de caché para que no comparta fallos con el mutex.
+    alignas(64) std::atomic<std::uint64_t> version{0};
+    tree_type tree;
+
+    // Complejidad: O(1) + f - ejecuta f(tree) en exclusiva y con la versión en impar
+    template<typename F>
+    decltype(auto) write_section(F&& f) {
+        std::unique_lock lock(mutex);
+        if constexpr (optimistic_reads) {
+            version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            // Las escrituras del árbol no pueden adelantarse a la versión impar
+            std::atomic_thread_fence(std::memory_order_release);
+            struct close_version {
+                std::atomic<std::uint64_t>& v;
+                ~close_version() { v.store(v.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+            } guard{version};
+            return f(tree);
+        } else {
+            return f(tree);
+        }
+    }
+
+    // Complejidad: O(log n) por intento. 1/0 si la búsqueda terminó sin que
+    // cambiara la versión, -1 si hay que repetirla
+    template<typename K>
+    int try_find_optimistic(const K& key) const {
+        std::uint64_t before = version.load(std::memory_order_acquire);
+        if (before & 1) return -1;
+        int result = tree.find_bounded(key, max_depth);
+        // Las lecturas del árbol no pueden retrasarse más allá de la segunda lectura de la versión
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (version.load(std::memory_order_relaxed) != before) return -1;
+        return result;
+    }
+
+    template<typename K>
+    bool find_impl(const K& key) const {
+        if constexpr (optimistic_reads) {
+            for (int attempt = 0; attempt < ReadPolicy::attempts; ++attempt) {
+                int r = try_find_optimistic(key);
+                if (r >= 0) return r == 1;
+            }
+        }
+        std::shared_lock lock(mutex);
+        return tree.find(key);
+    }
+
+public:
+    // Complejidad: O(1)
+    ConcurrentRBTree() = default;
+    explicit ConcurrentRBTree(const Compare& c) : tree(c) {}
+
+    // Complejidad: igual que el constructor de rango de RB_tree (carga masiva);
+    // el árbol todavía no es visible para otros hilos
+    template<typename It>
+    ConcurrentRBTree(It first, It last, bool parallel_sort = false, const Compare& c = Compare())
+        : tree(first, last, parallel_sort, c) {}
+
+    ConcurrentRBTree(const ConcurrentRBTree&) = delete;
+    ConcurrentRBTree& operator=(const ConcurrentRBTree&) = delete;
+
+    // Complejidad: O(log n) - en exclusiva
+    void add_leaf(const T& key) {
+        write_section([&](tree_type& t) { t.add_leaf(key); });
+    }
+    // Complejidad: O(log n) - en exclusiva; false si la clave ya estaba
+    bool insert_unique(const T& key) {
+        return write_section([&](tree_type& t) { return t.insert_unique(key).second; });
+    }
+    // Complejidad: O(log n) - en exclusiva
+    bool delete_leaf(const T& key) {
+        return write_section([&](tree_type& t) { return t.delete_leaf(key); });
+    }
+
+    // Complejidad: O(n) - en exclusiva. Con lecturas optimistas los nodos vuelven
+    // al pool en lugar de liberarse: un lector que aún esté bajando no puede
+    // encontrarse con memoria devuelta al sistema
+    void clear() {
+        write_section([](tree_type& t) {
+            if constexpr (optimistic_reads)
+                t.clear_keep_memory();
+            else
+                t.clear();
+        });
+    }
+
+    // Complejidad: O(log n) esperado sin escritores; con lecturas optimistas no
+    // escribe en memoria compartida, así que los lectores no se estorban entre sí
+    bool find(const T& key) const {
+        return find_impl(key);
+    }
+    template<typename K> requires transparent_compare<Compare>
+    bool find(const K& key) const {
+        return find_impl(key);
+    }
+
+    // Complejidad: O(m log n) - un solo shared_lock para todo el lote (ver RB_tree::find_many)
+    void find_many(std::span<const T> keys, std::span<bool> out) const {
+        std::shared_lock lock(mutex);
+        tree.find_many(keys, out);
+    }
+
+    // Complejidad: O(k + log n) - llama a f(clave) para cada clave del intervalo
+    // cerrado [lo, hi] en orden, bajo el shared_mutex (f no debe escribir en el árbol)
+    template<typename F>
+    void for_each_in_range(const T& lo, const T& hi, F&& f) const {
+        std::shared_lock lock(mutex);
+        for (auto it = tree.lower_bound(lo), end = tree.upper_bound(hi); it != end; ++it)
+            f(*it);
+    }
+
+    // Complejidad: O(1) + f - f(const tree_type&) bajo el shared_mutex: iteradores,
+    // rank, select... Nada que devuelva f debe apuntar dentro del árbol.
+    template<typename F>
+    decltype(auto) read(F&& f) const {
+        std::shared_lock lock(mutex);
+        return f(static_cast<const tree_type&>(tree));
+    }
+
+    // Complejidad: O(1) + f - f(tree_type&) en exclusiva, para agrupar varias escrituras
+    // bajo un solo lock. f no debe llamar a clear(), assign(), compact() ni
+    // compact_step(): liberan memoria (el pool entero o sus slabs viejos) que puede
+    // estar leyendo un lector optimista (para vaciar, usar clear() de esta clase).
+    template<typename F>
+    decltype(auto) write(F&& f) {
+        return write_section(std::forward<F>(f));
+    }
+
+    // Complejidad: O(1)
+    std::size_t size() const {
+        std::shared_lock lock(mutex);
+        return tree.size();
+    }
+    bool empty() const {
+        return size() == 0;
+    }
+};
+
+// Variante sin lecturas optimistas: todas las lecturas toman el shared_mutex
+template<typename T>
+using SharedLockRBTree = ConcurrentRBTree<T, std::less<T>, slab_pool, rb_pointer_layout, rb_no_augment,
+                                          rb_shared_lock_reads>;
+#endif //CONCURRENT_RB_TREE_H
@@ -0,0 +1,227 @@
+#ifndef FROZEN_INDEX_H
+#define FROZEN_INDEX_H
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include "TreeCompare.h"
+#include "TreePrefetch.h"
+#include "TreeSimd.h"
+
+// Índices de solo lectura construidos con freeze() de RB_tree o AVL.
+// Las claves se copian a un único arreglo contiguo con un orden pensado para la
+// caché, así que buscar no persigue punteros repartidos por el heap:
+//  - FrozenIndex: layout de Eytzinger (el árbol binario por niveles, hijo de k en
+//    2k y 2k + 1). Búsqueda sin saltos (el camino se calcula con aritmética, no con
+//    ifs) y prefetch de los nodos de cuatro niveles más abajo. Sirve para cualquier T.
+//  - FrozenBlockIndex: árbol B estático (S-tree) con una línea de caché de claves
+//    enteras por nodo; con AVX2 cada nodo se resuelve con dos comparaciones SIMD.
+// La entrada de los constructores debe estar ordenada (freeze() ya la da así).
+
+// Asignador alineado a línea de caché: un bloque de claves nunca cruza dos líneas
+template<typename T>
+struct cache_aligned_allocator {
+    using value_type = T;
+    static constexpr std::size_t alignment = 64;
+
+    cache_aligned_allocator() = default;
+    template<typename U>
+    cache_aligned_allocator(const cache_aligned_allocator<U>&) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignment)));
+    }
+    void deallocate(T* p, std::size_t) {
+        ::operator delete(p, std::align_val_t(alignment));
+    }
+    template<typename U>
+    bool operator==(const cache_aligned_allocator<U>&) const { return true; }
+};
+
+template<typename T, typename Compare = std::less<T>>
+class FrozenIndex {
+private:
+    // keys[0] no se usa (solo hace que la raíz sea el índice 1); keys[1..n] en orden de Eytzinger
+    std::vector<T, cache_aligned_allocator<T>> keys;
+    [[no_unique_address]] Compare comp;
+
+    // Claves por línea de caché: el prefetch pide el nodo k * line, que es el primer
+    // descendiente de k log2(line) niveles más abajo (sus hermanos van en la misma línea)
+    static constexpr std::size_t line =
+        (sizeof(T) <= 64 && 64 % sizeof(T) == 0) ? 64 / sizeof(T) : 1;
+
+    // Complejidad: O(n) - recorrido inorden del árbol implícito: la i-ésima clave
+    // ordenada acaba en el i-ésimo nodo visitado
+    template<typename It>
+    void fill(std::size_t k, It& it) {
+        if (k >= keys.size()) return;
+        fill(2 * k, it);
+        keys[k] = *it;
+        ++it;
+        fill(2 * k + 1, it);
+    }
+
+    // Complejidad: O(log n) - índice de la primera clave >= key (0 si no hay).
+    // En cada nivel se baja a 2k + (keys[k] < key): ningún if que predecir.
+    // Al salir, los bits bajos a 1 de k son los pasos a la derecha dados desde el
+    // último paso a la izquierda, que es el nodo buscado.
+    template<typename K>
+    std::size_t lower_index(const K& key) const {
+        const std::size_t n = keys.size() - 1;
+        const T* base = keys.data();
+        std::size_t k = 1;
+        while (k <= n) {
+            if constexpr (line > 1)
+                tree_prefetch(reinterpret_cast<const void*>(reinterpret_cast<std::uintptr_t>(base) + k * line * sizeof(T)));
+            k = 2 * k + static_cast<std::size_t>(comp(base[k], key));
+        }
+        return k >> (std::countr_one(k) + 1);
+    }
+
+public:
+    FrozenIndex() = default;
+
+    // Complejidad: O(n) - [first, last) ordenado según comp
+    template<typename It>
+    FrozenIndex(It first, It last, const Compare& c = Compare())
+        : FrozenIndex(first, static_cast<std::size_t>(std::distance(first, last)), c) {}
+
+    // Complejidad: O(n) - las n claves ordenadas desde first, en una sola pasada
+    // (freeze() ya conoce n y se ahorra recorrer el árbol dos veces)
+    template<typename It>
+    FrozenIndex(It first, std::size_t n, const Compare& c = Compare()) : comp(c) {
+        if (n == 0) return;
+        keys.assign(n + 1, *first);
+        fill(1, first);
+    }
+
+    // Complejidad: O(log n) - primera clave >= key, o nullptr si no hay
+    const T* lower_bound(const T& key) const {
+        if (keys.empty()) return nullptr;
+        std::size_t k = lower_index(key);
+        return k == 0 ? nullptr : &keys[k];
+    }
+    template<typename K> requires transparent_compare<Compare>
+    const T* lower_bound(const K& key) const {
+        if (keys.empty()) return nullptr;
+        std::size_t k = lower_index(key);
+        return k == 0 ? nullptr : &keys[k];
+    }
+
+    // Complejidad: O(log n)
+    bool find(const T& key) const {
+        const T* p = lower_bound(key);
+        return p != nullptr && !comp(key, *p);
+    }
+    template<typename K> requires transparent_compare<Compare>
+    bool find(const K& key) const {
+        const T* p = lower_bound(key);
+        return p != nullptr && !comp(key, *p);
+    }
+
+    // Complejidad: O(1)
+    std::size_t size() const {
+        return keys.empty() ? 0 : keys.size() - 1;
+    }
+    bool empty() const {
+        return keys.empty();
+    }
+    std::size_t memory_bytes() const {
+        return keys.capacity() * sizeof(T);
+    }
+};
+
+// S-tree: árbol B implícito con B = 64 / sizeof(T) claves por nodo (una línea de
+// caché) y B + 1 hijos; los hijos del nodo k son k (B + 1) + i + 1. Solo para claves
+// enteras de 4 u 8 bytes ordenadas con std::less. Cada nodo se resuelve contando
+// cuántas claves son < key (la posición del hijo) sin ramas con simd_rank
+// (TreeSimd.h): con AVX2, dos comparaciones de 256 bits y un popcount.
+template<typename T>
+class FrozenBlockIndex {
+    static_assert(simd_rank_key<T>, "FrozenBlockIndex: claves enteras de 4 u 8 bytes");
+
+private:
+    static constexpr std::size_t B = 64 / sizeof(T);
+    // Los huecos del último nivel se rellenan con el máximo: nunca son < key
+    static constexpr T pad = std::numeric_limits<T>::max();
+
+    std::vector<T, cache_aligned_allocator<T>> blocks; // nblocks * B claves
+    std::size_t nblocks = 0;
+    std::size_t count = 0;
+    T last{}; // mayor clave real (si key > last no hay lower_bound)
+
+    static std::size_t child(std::size_t k, std::size_t i) {
+        return k * (B + 1) + i + 1;
+    }
+
+    // Complejidad: O(n) - recorrido inorden de los nodos, como FrozenIndex::fill
+    template<typename It>
+    void fill(std::size_t k, It& it, std::size_t& taken) {
+        if (k >= nblocks) return;
+        for (std::size_t i = 0; i < B; ++i) {
+            fill(child(k, i), it, taken);
+            if (taken < count) {
+                blocks[k * B + i] = last = *it;
+                ++it;
+                ++taken;
+            }
+        }
+        fill(child(k, B), it, taken);
+    }
+
+public:
+    FrozenBlockIndex() = default;
+
+    // Complejidad: O(n) - [first, last) ordenado de menor a mayor
+    template<typename It>
+    FrozenBlockIndex(It first, It last, const std::less<T>& c = std::less<T>())
+        : FrozenBlockIndex(first, static_cast<std::size_t>(std::distance(first, last)), c) {}
+
+    // Complejidad: O(n) - las n claves ordenadas desde first, en una sola pasada
+    template<typename It>
+    FrozenBlockIndex(It first, std::size_t n, const std::less<T>& = std::less<T>()) {
+        count = n;
+        if (count == 0) return;
+        nblocks = (count + B - 1) / B;
+        blocks.assign(nblocks * B, pad);
+        std::size_t taken = 0;
+        fill(0, first, taken); // deja en last la última clave escrita, la mayor
+    }
+
+    // Complejidad: O(log_B n) nodos, cada uno una línea de caché
+    const T* lower_bound(T key) const {
+        if (count == 0 || last < key) return nullptr;
+        const T* result = nullptr;
+        std::size_t k = 0;
+        while (k < nblocks) {
+            const T* p = blocks.data() + k * B;
+            std::size_t i = simd_rank<B>(p, key);
+            if (i < B) result = p + i;
+            k = child(k, i);
+        }
+        return result;
+    }
+
+    // Complejidad: O(log_B n)
+    bool find(T key) const {
+        const T* p = lower_bound(key);
+        return p != nullptr && *p == key;
+    }
+
+    // Complejidad: O(1)
+    std::size_t size() const {
+        return count;
+    }
+    bool empty() const {
+        return count == 0;
+    }
+    std::size_t memory_bytes() const {
+        return blocks.capacity() * sizeof(T);
+    }
+};
+#endif //FROZEN_INDEX_H
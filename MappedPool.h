@@ -0,0 +1,377 @@
+#ifndef MAPPED_POOL_H
+#define MAPPED_POOL_H
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Región de un archivo proyectada en memoria compartida (MAP_SHARED): lo que se
+// escribe en ella acaba en el archivo. En modo escritura puede crecer (el archivo
+// se alarga y se vuelve a proyectar, quizá en otra dirección). Sin mmap ni
+// MapViewOfFile, open lanza std::runtime_error.
+class mapped_region {
+private:
+    std::byte* base = nullptr;
+    std::size_t length = 0;
+    bool writable = false;
+#if defined(_WIN32)
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+
+    // Complejidad: O(1) - proyecta los primeros bytes del archivo (ya abierto)
+    void map(std::size_t bytes) {
+        if (bytes == 0) return;
+#if defined(_WIN32)
+        DWORD protect = writable ? PAGE_READWRITE : PAGE_READONLY;
+        mapping = CreateFileMappingA(file, nullptr, protect, static_cast<DWORD>(std::uint64_t(bytes) >> 32),
+                                     static_cast<DWORD>(bytes), nullptr);
+        if (mapping != nullptr)
+            base = static_cast<std::byte*>(MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, bytes));
+        if (base == nullptr) throw std::runtime_error("mapped_region: no se puede proyectar el archivo");
+#elif defined(__unix__) || defined(__APPLE__)
+        void* p = ::mmap(nullptr, bytes, PROT_READ | (writable ? PROT_WRITE : 0), MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) throw std::runtime_error("mapped_region: no se puede proyectar el archivo");
+        base = static_cast<std::byte*>(p);
+#endif
+        length = bytes;
+    }
+
+    void unmap() {
+#if defined(_WIN32)
+        if (base != nullptr) UnmapViewOfFile(base);
+        if (mapping != nullptr) CloseHandle(mapping);
+        mapping = nullptr;
+#elif defined(__unix__) || defined(__APPLE__)
+        if (base != nullptr) ::munmap(base, length);
+#endif
+        base = nullptr;
+        length = 0;
+    }
+
+public:
+    mapped_region() = default;
+    mapped_region(const mapped_region&) = delete;
+    mapped_region& operator=(const mapped_region&) = delete;
+    mapped_region(mapped_region&& other) noexcept { *this = std::move(other); }
+    mapped_region& operator=(mapped_region&& other) noexcept {
+        if (this != &other) {
+            close();
+            base = std::exchange(other.base, nullptr);
+            length = std::exchange(other.length, 0);
+            writable = std::exchange(other.writable, false);
+#if defined(_WIN32)
+            file = std::exchange(other.file, INVALID_HANDLE_VALUE);
+            mapping = std::exchange(other.mapping, nullptr);
+#else
+            fd = std::exchange(other.fd, -1);
+#endif
+        }
+        return *this;
+    }
+    ~mapped_region() {
+        close();
+    }
+
+    // Complejidad: O(1) - proyecta el archivo entero. En escritura lo crea si no
+    // existe (con tamaño 0: size() == 0 hasta el primer resize)
+    void open(const std::string& path, bool read_only) {
+        close();
+        writable = !read_only;
+#if defined(_WIN32)
+        file = CreateFileA(path.c_str(), GENERIC_READ | (writable ? GENERIC_WRITE : 0),
+                           FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, writable ? OPEN_ALWAYS : OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("mapped_region: no se puede abrir " + path);
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            close();
+            throw std::runtime_error("mapped_region: no se puede leer el tamaño de " + path);
+        }
+        std::size_t bytes = static_cast<std::size_t>(size.QuadPart);
+#elif defined(__unix__) || defined(__APPLE__)
+        fd = ::open(path.c_str(), writable ? (O_RDWR | O_CREAT) : O_RDONLY, 0644);
+        if (fd < 0) throw std::runtime_error("mapped_region: no se puede abrir " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            close();
+            throw std::runtime_error("mapped_region: no se puede leer el tamaño de " + path);
+        }
+        std::size_t bytes = static_cast<std::size_t>(st.st_size);
+#else
+        throw std::runtime_error("mapped_region: esta plataforma no tiene archivos proyectados en memoria");
+#endif
+        try {
+            map(bytes);
+        } catch (...) {
+            close();
+            throw;
+        }
+    }
+
+    // Complejidad: O(1) más lo que tarde el sistema en alargar el archivo.
+    // Invalida data(): la proyección puede moverse
+    void resize(std::size_t bytes) {
+        if (!writable) throw std::logic_error("mapped_region: la región es de solo lectura");
+#if defined(_WIN32)
+        unmap(); // CreateFileMapping alarga el archivo hasta el tamaño pedido
+        map(bytes);
+#elif defined(__unix__) || defined(__APPLE__)
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+            throw std::runtime_error("mapped_region: no se puede alargar el archivo");
+#ifdef MREMAP_MAYMOVE
+        if (base != nullptr) {
+            void* p = ::mremap(base, length, bytes, MREMAP_MAYMOVE);
+            if (p == MAP_FAILED) throw std::runtime_error("mapped_region: no se puede volver a proyectar el archivo");
+            base = static_cast<std::byte*>(p);
+            length = bytes;
+            return;
+        }
+#endif
+        unmap();
+        map(bytes);
+#endif
+    }
+
+    // Complejidad: O(páginas modificadas) - escribe en disco lo modificado
+    void sync() {
+        if (base == nullptr || !writable) return;
+#if defined(_WIN32)
+        FlushViewOfFile(base, 0);
+        FlushFileBuffers(file);
+#elif defined(__unix__) || defined(__APPLE__)
+        ::msync(base, length, MS_SYNC);
+#endif
+    }
+
+    void close() {
+        unmap();
+#if defined(_WIN32)
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+        writable = false;
+    }
+
+    std::byte* data() const {
+        return base;
+    }
+    std::size_t size() const {
+        return length;
+    }
+    bool read_only() const {
+        return !writable;
+    }
+    bool is_open() const {
+#if defined(_WIN32)
+        return file != INVALID_HANDLE_VALUE;
+#else
+        return fd >= 0;
+#endif
+    }
+};
+
+// Pool de nodos que vive dentro de un archivo proyectado (para rb_index_layout).
+// Como index_pool, entrega índices de 32 bits en lugar de punteros, pero todos los
+// huecos están en un solo arreglo tras una cabecera de 64 bytes: at(i) es
+// base + 64 + i * sizeof(hueco). La lista libre y los contadores también están en
+// la cabecera, así que el archivo contiene el pool entero y reabrirlo cuesta O(1).
+// Los índices no dependen de la dirección de la proyección: crecer (alargar el
+// archivo y volver a proyectarlo) no invalida ningún enlace.
+// Los nodos deben ser trivialmente copiables: se guardan byte a byte. Sin open()
+// no hay dónde crear nodos (create lanza std::logic_error).
+template<typename N>
+class mapped_pool {
+public:
+    using index_type = std::uint32_t;
+    // El bit bajo del campo padre guarda el color, así que quedan 31 bits de índice
+    static constexpr index_type nil = 0x7FFFFFFFu;
+
+    static constexpr bool bulk_release = true;
+    // Crecer puede mover la proyección: at(i) no es seguro frente a un escritor
+    static constexpr bool stable_addresses = false;
+    static constexpr bool transferable_nodes = false;
+
+    // Palabras de la cabecera reservadas al dueño del pool (MappedRBTree guarda
+    // ahí la raíz, el mínimo, el máximo y el número de claves)
+    static constexpr std::size_t user_words = 4;
+
+private:
+    static_assert(std::is_trivially_copyable_v<N>, "mapped_pool: los nodos se guardan byte a byte en el archivo");
+
+    union slot {
+        index_type next;
+        alignas(N) unsigned char storage[sizeof(N)];
+    };
+    static_assert(alignof(slot) <= 64, "mapped_pool: los huecos empiezan en el byte 64");
+
+    struct header {
+        char magic[8];           // "RBMAP01"
+        std::uint32_t slot_bytes; // sizeof(slot): el archivo solo sirve para este tipo de nodo
+        std::uint32_t byte_order;
+        std::uint64_t capacity;  // huecos que caben en el archivo
+        index_type next_index;   // siguiente hueco nunca usado
+        index_type free_list;
+        std::uint64_t user[user_words];
+    };
+    static_assert(sizeof(header) == 64, "mapped_pool: cabecera de 64 bytes");
+
+    static constexpr char magic[8] = {'R', 'B', 'M', 'A', 'P', '0', '1', '\0'};
+    static constexpr std::uint32_t byte_order = 0x01020304u;
+    // Huecos de un archivo nuevo (~64 KiB); después se duplica al llenarse
+    static constexpr std::uint64_t initial_capacity = (65536 / sizeof(slot)) < 16 ? 16 : (65536 / sizeof(slot));
+
+    mapped_region region;
+
+    header& head() const {
+        return *reinterpret_cast<header*>(region.data());
+    }
+    slot& slot_at(index_type i) const {
+        return reinterpret_cast<slot*>(region.data() + sizeof(header))[i];
+    }
+
+    static std::size_t bytes_for(std::uint64_t capacity) {
+        return sizeof(header) + static_cast<std::size_t>(capacity) * sizeof(slot);
+    }
+
+    // Complejidad: O(1) amortizado - duplica el archivo
+    void grow() {
+        std::uint64_t capacity = head().capacity * 2;
+        if (capacity > nil) capacity = nil;
+        region.resize(bytes_for(capacity));
+        head().capacity = capacity;
+    }
+
+public:
+    mapped_pool() = default;
+    mapped_pool(const mapped_pool&) = delete;
+    mapped_pool& operator=(const mapped_pool&) = delete;
+    mapped_pool(mapped_pool&&) noexcept = default;
+    mapped_pool& operator=(mapped_pool&&) noexcept = default;
+
+    // Complejidad: O(1) - proyecta path. En escritura, un archivo nuevo o vacío
+    // se inicializa como un pool vacío; uno existente debe ser un pool de este tipo
+    // de nodo (si no, std::runtime_error)
+    void open(const std::string& path, bool read_only) {
+        region.open(path, read_only);
+        try {
+            if (region.size() == 0 && !read_only) {
+                region.resize(bytes_for(initial_capacity));
+                header& h = head();
+                std::memcpy(h.magic, magic, sizeof magic);
+                h.slot_bytes = sizeof(slot);
+                h.byte_order = byte_order;
+                h.capacity = initial_capacity;
+                h.next_index = 0;
+                h.free_list = nil;
+                for (std::uint64_t& w : h.user) w = 0;
+                return;
+            }
+            if (region.size() < sizeof(header))
+                throw std::runtime_error("mapped_pool: " + path + " no es un pool de nodos");
+            const header& h = head();
+            if (std::memcmp(h.magic, magic, sizeof magic) != 0 || h.slot_bytes != sizeof(slot) ||
+                h.byte_order != byte_order)
+                throw std::runtime_error("mapped_pool: " + path + " no es un pool de este tipo de nodo");
+            if (h.capacity > nil || region.size() < bytes_for(h.capacity) || h.next_index > h.capacity)
+                throw std::runtime_error("mapped_pool: " + path + " está truncado");
+        } catch (...) {
+            region.close();
+            throw;
+        }
+    }
+
+    // Complejidad: O(1) - deja de proyectar el archivo (los nodos siguen en él)
+    void close() {
+        region.close();
+    }
+    // Complejidad: O(páginas modificadas)
+    void sync() {
+        region.sync();
+    }
+
+    bool is_open() const {
+        return region.is_open() && region.data() != nullptr;
+    }
+    bool read_only() const {
+        return region.read_only();
+    }
+
+    std::uint64_t& user(std::size_t i) const {
+        return head().user[i];
+    }
+    // Huecos usados alguna vez: todo índice válido es menor
+    index_type used_slots() const {
+        return head().next_index;
+    }
+
+    // Complejidad: O(1) amortizado. Si hay que crecer, el nodo se construye antes:
+    // args puede apuntar dentro de la proyección (una clave del propio árbol), que
+    // grow() puede mover
+    template<typename... Args>
+    index_type create(Args&&... args) {
+        if (!is_open() || read_only()) throw std::logic_error("mapped_pool: no hay un archivo abierto en escritura");
+        index_type i;
+        if (head().free_list != nil) {
+            i = head().free_list;
+            head().free_list = slot_at(i).next;
+        } else {
+            if (head().next_index == nil)
+                throw std::length_error("mapped_pool: se agotaron los índices de 31 bits");
+            if (head().next_index == head().capacity) {
+                N value(std::forward<Args>(args)...);
+                grow();
+                i = head().next_index++;
+                ::new (static_cast<void*>(slot_at(i).storage)) N(value);
+                return i;
+            }
+            i = head().next_index++;
+        }
+        ::new (static_cast<void*>(slot_at(i).storage)) N(std::forward<Args>(args)...);
+        return i;
+    }
+
+    // Complejidad: O(1) - el hueco vuelve a la lista libre del archivo
+    void destroy(index_type i) {
+        slot_at(i).next = head().free_list;
+        head().free_list = i;
+    }
+
+    // Complejidad: O(1) - una carga (la base de la proyección) y el nodo
+    N& at(index_type i) const {
+        return *std::launder(reinterpret_cast<N*>(slot_at(i).storage));
+    }
+
+    // Complejidad: O(1) - vacía el pool; el archivo conserva su tamaño.
+    // Sin archivo abierto en escritura no hace nada (el RB_tree lo llama al destruirse)
+    void release() {
+        if (!is_open() || read_only()) return;
+        head().next_index = 0;
+        head().free_list = nil;
+    }
+
+    std::size_t reserved_bytes() const {
+        return region.size();
+    }
+};
+#endif //MAPPED_POOL_H
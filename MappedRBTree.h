@@ -0,0 +1,166 @@
+#ifndef MAPPED_RB_TREE_H
+#define MAPPED_RB_TREE_H
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "MappedPool.h"
+#include "RB_tree.h"
+
+// RB_tree que vive entero dentro de un archivo proyectado en memoria: no hay paso
+// de carga. Los nodos usan rb_index_layout (enlaces de 32 bits, que son posiciones
+// dentro del archivo y no punteros) sobre un mapped_pool, y la raíz, el mínimo, el
+// máximo y el número de claves se guardan en la cabecera del pool tras cada
+// escritura. Abrir un archivo existente cuesta O(1); las páginas se leen del
+// disco (o de la caché del sistema) la primera vez que una búsqueda las toca.
+//
+// Con read_only = true la proyección es de solo lectura y las escrituras lanzan
+// std::logic_error: varios procesos pueden abrir el mismo archivo y compartir las
+// mismas páginas físicas del índice. Que un proceso escriba mientras otros leen no
+// está sincronizado (ni se ven los nodos añadidos tras crecer el archivo): los
+// lectores deben abrir el archivo cuando el escritor haya terminado.
+//
+// Solo claves trivialmente copiables (se guardan byte a byte) y un archivo
+// pertenece a un tipo de clave y de comparador concretos.
+template<typename T, typename Compare = std::less<T>, typename Augment = rb_no_augment>
+class MappedRBTree {
+    static_assert(std::is_trivially_copyable_v<T>, "MappedRBTree: las claves se guardan byte a byte en el archivo");
+
+public:
+    using tree_type = RB_tree<T, Compare, mapped_pool, rb_index_layout, Augment>;
+    using const_iterator = typename tree_type::const_iterator;
+    using iterator = const_iterator;
+
+private:
+    tree_type tree;
+
+    auto& pool() { return tree.pool; }
+    const auto& pool() const { return tree.pool; }
+
+    void check_writable() const {
+        if (pool().read_only()) throw std::logic_error("MappedRBTree: el archivo está abierto en solo lectura");
+    }
+
+    // Complejidad: O(1) - deja en la cabecera del archivo el estado del árbol
+    void publish() {
+        pool().user(0) = tree.root;
+        pool().user(1) = tree.leftmost;
+        pool().user(2) = tree.rightmost;
+        pool().user(3) = tree.node_count;
+    }
+
+public:
+    // Complejidad: O(1) - abre (o, en escritura, crea) el árbol guardado en path.
+    // Lanza std::runtime_error si la cabecera apunta fuera de los nodos del archivo
+    explicit MappedRBTree(const std::string& path, bool read_only = false, const Compare& c = Compare()) : tree(c) {
+        pool().open(path, read_only);
+        std::uint64_t used = pool().used_slots();
+        std::uint64_t count = pool().user(3);
+        if (count == 0) return; // archivo nuevo o vacío (cabecera a cero)
+        bool valid = count <= used;
+        for (std::size_t i = 0; i < 3; ++i)
+            valid = valid && pool().user(i) < used;
+        if (!valid) {
+            pool().close();
+            throw std::runtime_error("MappedRBTree: " + path + " tiene una cabecera corrupta");
+        }
+        auto handle = [&](std::size_t i) { return static_cast<typename tree_type::node_ptr>(pool().user(i)); };
+        tree.node_count = static_cast<std::size_t>(count);
+        tree.root = handle(0);
+        tree.leftmost = handle(1);
+        tree.rightmost = handle(2);
+    }
+
+    MappedRBTree(const MappedRBTree&) = delete;
+    MappedRBTree& operator=(const MappedRBTree&) = delete;
+
+    // Complejidad: O(1) - el árbol se queda en el archivo; RB_tree no lo vacía al
+    // destruirse porque el pool ya está cerrado
+    ~MappedRBTree() {
+        pool().close();
+        tree.root = tree.leftmost = tree.rightmost = tree_type::nil;
+        tree.node_count = 0;
+    }
+
+    // Complejidad: O(log n), como en RB_tree (más un alargamiento del archivo de vez en cuando)
+    void add_leaf(const T& key) {
+        check_writable();
+        tree.add_leaf(key);
+        publish();
+    }
+    // Complejidad: O(log n) - false si la clave ya estaba
+    bool insert_unique(const T& key) {
+        check_writable();
+        bool inserted = tree.insert_unique(key).second;
+        publish();
+        return inserted;
+    }
+    // Complejidad: O(log n) - el nodo vuelve a la lista libre del archivo
+    bool delete_leaf(const T& key) {
+        check_writable();
+        bool erased = tree.delete_leaf(key);
+        publish();
+        return erased;
+    }
+    // Complejidad: O(n) si [first, last) ya está ordenado (ver RB_tree::assign)
+    template<typename It>
+    void assign(It first, It last) {
+        check_writable();
+        tree.assign(first, last);
+        publish();
+    }
+    // Complejidad: O(1) - el archivo conserva su tamaño para reutilizarlo
+    void clear() {
+        check_writable();
+        tree.clear();
+        publish();
+    }
+
+    // Complejidad: O(páginas modificadas) - fuerza la escritura en disco
+    void sync() {
+        pool().sync();
+    }
+
+    // Complejidad: O(log n)
+    bool find(const T& key) const {
+        return tree.find(key);
+    }
+    // Complejidad: O(m log n) - ver RB_tree::find_many
+    void find_many(std::span<const T> keys, std::span<bool> out) const {
+        tree.find_many(keys, out);
+    }
+    const_iterator lower_bound(const T& key) const {
+        return tree.lower_bound(key);
+    }
+    const_iterator upper_bound(const T& key) const {
+        return tree.upper_bound(key);
+    }
+    const_iterator begin() const {
+        return tree.begin();
+    }
+    const_iterator end() const {
+        return tree.end();
+    }
+
+    // El RB_tree de solo lectura, para el resto de consultas (rank, select, freeze...)
+    const tree_type& view() const {
+        return tree;
+    }
+
+    // Complejidad: O(1)
+    std::size_t size() const {
+        return tree.size();
+    }
+    bool empty() const {
+        return tree.empty();
+    }
+    bool read_only() const {
+        return pool().read_only();
+    }
+    std::size_t file_bytes() const {
+        return pool().reserved_bytes();
+    }
+};
+#endif //MAPPED_RB_TREE_H
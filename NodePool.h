@@ -0,0 +1,365 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Pool de nodos por bloques (slab): reserva los nodos en trozos contiguos de
+// memoria y reutiliza los huecos liberados mediante una lista libre intrusiva.
+// Los nodos creados uno detrás de otro quedan juntos en memoria y la liberación
+// total del árbol cuesta O(#slabs) en lugar de un delete por nodo.
+template<typename N>
+class slab_pool {
+private:
+    // Un hueco libre reutiliza la memoria del propio nodo para enlazar la lista
+    union slot {
+        slot* next;
+        alignas(N) unsigned char storage[sizeof(N)];
+    };
+
+    // ~64 KiB por slab, y al menos 16 nodos
+    static constexpr std::size_t slab_nodes =
+        (65536 / sizeof(slot)) < 16 ? 16 : (65536 / sizeof(slot));
+
+    std::vector<slot*> slabs;
+    slot* free_list = nullptr;
+    std::size_t used_in_last = slab_nodes; // huecos consumidos del último slab
+    // Región nueva (compactación incremental del RB_tree): mientras está abierta los
+    // nodos salen solo de slabs nuevos, a partir de slabs[fresh_from]. Los huecos de
+    // los slabs viejos van a old_free y no se reutilizan.
+    bool fresh_region = false;
+    std::size_t fresh_from = 0;
+    slot* old_free = nullptr;
+    std::vector<slot*> old_slabs; // slabs viejos ordenados por dirección
+
+    // Complejidad: O(1) amortizado
+    slot* take_slot() {
+        if (free_list != nullptr) {
+            slot* s = free_list;
+            free_list = s->next;
+            return s;
+        }
+        if (used_in_last == slab_nodes) {
+            slabs.push_back(static_cast<slot*>(::operator new(slab_nodes * sizeof(slot), std::align_val_t(alignof(slot)))));
+            used_in_last = 0;
+        }
+        return &slabs.back()[used_in_last++];
+    }
+
+public:
+    // Si es true, el árbol puede soltar todos sus nodos con release() sin recorrerlos
+    static constexpr bool bulk_release = true;
+    // Si es true, la dirección de un nodo sigue apuntando a memoria del pool (de un
+    // nodo vivo o de un hueco libre) hasta release() o end_fresh_region(), o hasta que
+    // el pool se reemplaza por otro (RB_tree::compact): un lector concurrente que siga
+    // un enlace desactualizado no toca memoria devuelta al sistema (ConcurrentRBTree)
+    static constexpr bool stable_addresses = true;
+    // Si es true, un nodo puede pasar a otro árbol con otro pool (ver RB_tree::split)
+    static constexpr bool transferable_nodes = false;
+
+    slab_pool() = default;
+    slab_pool(const slab_pool&) = delete;
+    slab_pool& operator=(const slab_pool&) = delete;
+    slab_pool(slab_pool&& other) noexcept
+        : slabs(std::move(other.slabs)), free_list(other.free_list), used_in_last(other.used_in_last),
+          fresh_region(other.fresh_region), fresh_from(other.fresh_from), old_free(other.old_free),
+          old_slabs(std::move(other.old_slabs)) {
+        other.slabs.clear();
+        other.free_list = nullptr;
+        other.used_in_last = slab_nodes;
+        other.fresh_region = false;
+        other.old_free = nullptr;
+        other.old_slabs.clear();
+    }
+    slab_pool& operator=(slab_pool&& other) noexcept {
+        if (this != &other) {
+            release();
+            slabs = std::move(other.slabs);
+            free_list = other.free_list;
+            used_in_last = other.used_in_last;
+            fresh_region = other.fresh_region;
+            fresh_from = other.fresh_from;
+            old_free = other.old_free;
+            old_slabs = std::move(other.old_slabs);
+            other.slabs.clear();
+            other.free_list = nullptr;
+            other.used_in_last = slab_nodes;
+            other.fresh_region = false;
+            other.old_free = nullptr;
+            other.old_slabs.clear();
+        }
+        return *this;
+    }
+    ~slab_pool() {
+        release();
+    }
+
+    // Complejidad: O(1) amortizado - toma un hueco de la lista libre o del último slab
+    template<typename... Args>
+    N* create(Args&&... args) {
+        slot* s = take_slot();
+        try {
+            return ::new (static_cast<void*>(s->storage)) N(std::forward<Args>(args)...);
+        } catch (...) {
+            s->next = free_list;
+            free_list = s;
+            throw;
+        }
+    }
+
+    // Complejidad: O(1) (O(log #slabs) con una región nueva abierta) - destruye el
+    // nodo y devuelve su hueco a la lista libre
+    void destroy(N* p) {
+        p->~N();
+        slot* s = reinterpret_cast<slot*>(p);
+        if (fresh_region && in_old_region(p)) {
+            s->next = old_free;
+            old_free = s;
+            return;
+        }
+        s->next = free_list;
+        free_list = s;
+    }
+
+    // Complejidad: O(#slabs) - libera toda la memoria sin llamar a los destructores
+    // de los nodos vivos (el árbol los destruye antes si no son triviales)
+    void release() {
+        for (slot* s : slabs)
+            ::operator delete(s, std::align_val_t(alignof(slot)));
+        slabs.clear();
+        free_list = nullptr;
+        used_in_last = slab_nodes;
+        fresh_region = false;
+        old_free = nullptr;
+        old_slabs.clear();
+    }
+
+    // Complejidad: O(#slabs log #slabs) - a partir de aquí create() llena slabs nuevos
+    // en orden (los nodos que se vayan recreando quedan contiguos) y los huecos de los
+    // slabs viejos se apartan en vez de reutilizarse
+    void begin_fresh_region() {
+        fresh_region = true;
+        fresh_from = slabs.size();
+        used_in_last = slab_nodes; // el slab a medias es viejo: no se sigue llenando
+        old_free = free_list;
+        free_list = nullptr;
+        old_slabs.assign(slabs.begin(), slabs.end());
+        std::sort(old_slabs.begin(), old_slabs.end(), std::less<slot*>());
+    }
+    bool in_fresh_region() const {
+        return fresh_region;
+    }
+    // Complejidad: O(log #slabs) - true si p está en un slab anterior a la región nueva
+    bool in_old_region(const void* p) const {
+        const slot* s = static_cast<const slot*>(p);
+        auto it = std::upper_bound(old_slabs.begin(), old_slabs.end(), s, std::less<const slot*>());
+        return it != old_slabs.begin() && std::less<const slot*>()(s, *(it - 1) + slab_nodes);
+    }
+    // Complejidad: O(huecos liberados en la región) - abandona la región sin soltar
+    // nada: los slabs viejos siguen en uso y sus huecos vuelven a la lista libre
+    void cancel_fresh_region() {
+        if (!fresh_region) return;
+        fresh_region = false;
+        if (free_list == nullptr) {
+            free_list = old_free;
+        } else {
+            slot* tail = free_list;
+            while (tail->next != nullptr) tail = tail->next;
+            tail->next = old_free;
+        }
+        old_free = nullptr;
+        old_slabs.clear();
+    }
+
+    // Complejidad: O(#slabs viejos) - cierra la región: los slabs anteriores ya no
+    // tienen nodos vivos (el árbol los ha recreado todos) y se devuelven al sistema
+    void end_fresh_region() {
+        if (!fresh_region) return;
+        fresh_region = false;
+        for (std::size_t i = 0; i < fresh_from; ++i)
+            ::operator delete(slabs[i], std::align_val_t(alignof(slot)));
+        slabs.erase(slabs.begin(), slabs.begin() + static_cast<std::ptrdiff_t>(fresh_from));
+        old_free = nullptr;
+        old_slabs.clear();
+    }
+
+    // Complejidad: O(#slabs de other) - se queda con los slabs de other, cuyos nodos
+    // siguen en la misma dirección. Lo usan join y las operaciones de conjuntos del
+    // RB_tree para unir dos árboles sin copiar nodos. other queda vacío.
+    void absorb(slab_pool&& other) {
+        if (this == &other || other.slabs.empty()) return;
+        if (fresh_region || other.fresh_region)
+            throw std::logic_error("slab_pool::absorb: hay una región nueva abierta");
+        // Los huecos nunca usados del último slab de other pasan a la lista libre:
+        // ese slab deja de ser el último y take_slot ya no los vería
+        slot* other_last = other.slabs.back();
+        for (std::size_t i = other.used_in_last; i < slab_nodes; ++i) {
+            other_last[i].next = other.free_list;
+            other.free_list = &other_last[i];
+        }
+        if (slabs.empty()) {
+            slabs = std::move(other.slabs);
+            used_in_last = slab_nodes;
+        } else {
+            // El último slab propio (quizá a medias) sigue siendo el último
+            slabs.insert(slabs.end() - 1, other.slabs.begin(), other.slabs.end());
+        }
+        if (other.free_list != nullptr) {
+            slot* tail = other.free_list;
+            while (tail->next != nullptr) tail = tail->next;
+            tail->next = free_list;
+            free_list = other.free_list;
+        }
+        other.slabs.clear();
+        other.free_list = nullptr;
+        other.used_in_last = slab_nodes;
+    }
+
+    // Bytes reservados por el pool (para los benchmarks de memoria)
+    std::size_t reserved_bytes() const {
+        return slabs.size() * slab_nodes * sizeof(slot);
+    }
+};
+
+// Política equivalente al comportamiento original: un new/delete por nodo
+template<typename N>
+class heap_pool {
+public:
+    static constexpr bool bulk_release = false;
+    static constexpr bool stable_addresses = false;
+    // Cada nodo es una reserva independiente: cualquier heap_pool puede destruirlo
+    static constexpr bool transferable_nodes = true;
+
+    // Complejidad: O(1) - delega en el asignador global
+    template<typename... Args>
+    N* create(Args&&... args) {
+        return new N(std::forward<Args>(args)...);
+    }
+
+    // Complejidad: O(1)
+    void destroy(N* p) {
+        delete p;
+    }
+
+    // No hay nada que soltar en bloque: el árbol destruye cada nodo con destroy()
+    void release() {}
+
+    // Complejidad: O(1) - los nodos de other ya son reservas independientes
+    void absorb(heap_pool&&) {}
+};
+
+// Pool direccionado por índices de 32 bits: los nodos se enlazan con índices en
+// lugar de punteros (ver rb_index_layout). Los slabs tienen un número de nodos
+// potencia de dos para que at(i) sea un desplazamiento y una máscara.
+template<typename N>
+class index_pool {
+public:
+    using index_type = std::uint32_t;
+    // El bit bajo del campo padre guarda el color, así que quedan 31 bits de índice
+    static constexpr index_type nil = 0x7FFFFFFFu;
+
+private:
+    union slot {
+        index_type next;
+        alignas(N) unsigned char storage[sizeof(N)];
+    };
+
+    static constexpr std::size_t slab_nodes =
+        std::bit_floor((65536 / sizeof(slot)) < 16 ? std::size_t(16) : (65536 / sizeof(slot)));
+    static constexpr unsigned slab_shift = std::countr_zero(slab_nodes);
+
+    std::vector<slot*> slabs;
+    index_type free_list = nil;
+    index_type next_index = 0; // siguiente índice nunca usado
+
+    slot& slot_at(index_type i) const {
+        return slabs[i >> slab_shift][i & (slab_nodes - 1)];
+    }
+
+public:
+    static constexpr bool bulk_release = true;
+    // La tabla de slabs se realoja al crecer: at(i) no es seguro frente a un escritor
+    static constexpr bool stable_addresses = false;
+    static constexpr bool transferable_nodes = false;
+
+    index_pool() = default;
+    index_pool(const index_pool&) = delete;
+    index_pool& operator=(const index_pool&) = delete;
+    index_pool(index_pool&& other) noexcept
+        : slabs(std::move(other.slabs)), free_list(other.free_list), next_index(other.next_index) {
+        other.slabs.clear();
+        other.free_list = nil;
+        other.next_index = 0;
+    }
+    index_pool& operator=(index_pool&& other) noexcept {
+        if (this != &other) {
+            release();
+            slabs = std::move(other.slabs);
+            free_list = other.free_list;
+            next_index = other.next_index;
+            other.slabs.clear();
+            other.free_list = nil;
+            other.next_index = 0;
+        }
+        return *this;
+    }
+    ~index_pool() {
+        release();
+    }
+
+    // Complejidad: O(1) amortizado
+    template<typename... Args>
+    index_type create(Args&&... args) {
+        index_type i;
+        if (free_list != nil) {
+            i = free_list;
+            free_list = slot_at(i).next;
+        } else {
+            if (next_index == nil)
+                throw std::length_error("index_pool: se agotaron los índices de 31 bits");
+            if ((next_index & (slab_nodes - 1)) == 0)
+                slabs.push_back(static_cast<slot*>(::operator new(slab_nodes * sizeof(slot), std::align_val_t(alignof(slot)))));
+            i = next_index++;
+        }
+        try {
+            ::new (static_cast<void*>(slot_at(i).storage)) N(std::forward<Args>(args)...);
+        } catch (...) {
+            slot_at(i).next = free_list;
+            free_list = i;
+            throw;
+        }
+        return i;
+    }
+
+    // Complejidad: O(1)
+    void destroy(index_type i) {
+        at(i).~N();
+        slot_at(i).next = free_list;
+        free_list = i;
+    }
+
+    // Complejidad: O(1) - dos cargas: la tabla de slabs y el nodo
+    N& at(index_type i) const {
+        return *std::launder(reinterpret_cast<N*>(slot_at(i).storage));
+    }
+
+    // Complejidad: O(#slabs)
+    void release() {
+        for (slot* s : slabs)
+            ::operator delete(s, std::align_val_t(alignof(slot)));
+        slabs.clear();
+        free_list = nil;
+        next_index = 0;
+    }
+
+    std::size_t reserved_bytes() const {
+        return slabs.size() * slab_nodes * sizeof(slot);
+    }
+};
+#endif //NODE_POOL_H
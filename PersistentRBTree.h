@@ -0,0 +1,337 @@
+#ifndef PERSISTENT_RB_TREE_H
+#define PERSISTENT_RB_TREE_H
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "TreeCompare.h"
+
+// Árbol rojo-negro persistente (copia de camino).
+//
+// Los nodos son inmutables y se comparten entre versiones: add_leaf y delete_leaf
+// construyen una versión nueva copiando solo los O(log n) nodos del camino desde
+// la raíz y reutilizando el resto. snapshot() devuelve en O(1) una versión que ya
+// no cambiará aunque sigan las escrituras, y se puede leer desde cualquier hilo
+// sin locks. Los nodos se liberan por conteo de referencias (shared_ptr) cuando
+// ninguna versión viva los alcanza.
+//
+// Inserción de Okasaki y borrado de Kahrs ("Red-black trees with types", 2001):
+// en lugar de punteros al padre y rotaciones in situ, las funciones devuelven el
+// subárbol reconstruido y balance/balleft/balright restauran los invariantes.
+// Admite duplicados como RB_tree (una clave igual baja al subárbol derecho).
+template<typename T, typename Compare = std::less<T>>
+class PersistentRBTree {
+private:
+    struct node;
+    using node_ptr = std::shared_ptr<const node>;
+
+    // Nodos vivos de todas las versiones (para los benchmarks de memoria)
+    static inline std::atomic<std::size_t> live{0};
+
+    struct node {
+        bool red;
+        T key;
+        node_ptr left;
+        node_ptr right;
+        node(bool r, node_ptr l, const T& k, node_ptr rt)
+            : red(r), key(k), left(std::move(l)), right(std::move(rt)) {
+            live.fetch_add(1, std::memory_order_relaxed);
+        }
+        ~node() {
+            live.fetch_sub(1, std::memory_order_relaxed);
+        }
+    };
+
+    // Una versión: raíz y tamaño se publican juntos
+    struct version {
+        node_ptr root;
+        std::size_t size = 0;
+    };
+
+    std::atomic<std::shared_ptr<const version>> current;
+    std::mutex writer; // un escritor cada vez; los lectores no lo tocan
+    [[no_unique_address]] Compare comp;
+
+    static bool is_red(const node_ptr& x) { return x && x->red; }
+    static bool is_black_node(const node_ptr& x) { return x && !x->red; }
+
+    // Complejidad: O(1) - un nodo nuevo
+    static node_ptr make(bool red, node_ptr l, const T& key, node_ptr r) {
+        return std::make_shared<const node>(red, std::move(l), key, std::move(r));
+    }
+    static node_ptr make_black(const node_ptr& x) {
+        return x->red ? make(false, x->left, x->key, x->right) : x;
+    }
+
+    // Complejidad: O(1) - a x b con a o b rojo con un hijo rojo (o ambos rojos)
+    // se reescribe como rojo con dos hijos negros; en otro caso nodo negro
+    static node_ptr balance(node_ptr a, const T& x, node_ptr b) {
+        if (is_red(a) && is_red(b))
+            return make(true, make(false, a->left, a->key, a->right), x, make(false, b->left, b->key, b->right));
+        if (is_red(a)) {
+            if (is_red(a->left))
+                return make(true, make(false, a->left->left, a->left->key, a->left->right), a->key,
+                            make(false, a->right, x, std::move(b)));
+            if (is_red(a->right))
+                return make(true, make(false, a->left, a->key, a->right->left), a->right->key,
+                            make(false, a->right->right, x, std::move(b)));
+        }
+        if (is_red(b)) {
+            if (is_red(b->right))
+                return make(true, make(false, std::move(a), x, b->left), b->key,
+                            make(false, b->right->left, b->right->key, b->right->right));
+            if (is_red(b->left))
+                return make(true, make(false, std::move(a), x, b->left->left), b->left->key,
+                            make(false, b->left->right, b->key, b->right));
+        }
+        return make(false, std::move(a), x, std::move(b));
+    }
+
+    // Rojo a partir de un nodo negro (solo se llama sobre nodos negros)
+    static node_ptr redden(const node_ptr& x) {
+        return make(true, x->left, x->key, x->right);
+    }
+
+    // Complejidad: O(1) - el subárbol izquierdo bl perdió un nivel negro
+    static node_ptr balleft(node_ptr bl, const T& x, node_ptr r) {
+        if (is_red(bl))
+            return make(true, make(false, bl->left, bl->key, bl->right), x, std::move(r));
+        if (is_black_node(r))
+            return balance(std::move(bl), x, redden(r));
+        // r rojo con hijo izquierdo negro
+        const node_ptr& rl = r->left;
+        return make(true, make(false, std::move(bl), x, rl->left), rl->key,
+                    balance(rl->right, r->key, redden(r->right)));
+    }
+
+    // Complejidad: O(1) - simétrico: el subárbol derecho bl perdió un nivel negro
+    static node_ptr balright(node_ptr l, const T& x, node_ptr bl) {
+        if (is_red(bl))
+            return make(true, std::move(l), x, make(false, bl->left, bl->key, bl->right));
+        if (is_black_node(l))
+            return balance(redden(l), x, std::move(bl));
+        const node_ptr& lr = l->right;
+        return make(true, balance(redden(l->left), l->key, lr->left), lr->key,
+                    make(false, lr->right, x, std::move(bl)));
+    }
+
+    // Complejidad: O(log n) - une dos subárboles de la misma altura negra
+    // (todas las claves de a <= las de b) tras quitar su padre
+    static node_ptr append(const node_ptr& a, const node_ptr& b) {
+        if (!a) return b;
+        if (!b) return a;
+        if (a->red && b->red) {
+            node_ptr bc = append(a->right, b->left);
+            if (is_red(bc))
+                return make(true, make(true, a->left, a->key, bc->left), bc->key, make(true, bc->right, b->key, b->right));
+            return make(true, a->left, a->key, make(true, std::move(bc), b->key, b->right));
+        }
+        if (!a->red && !b->red) {
+            node_ptr bc = append(a->right, b->left);
+            if (is_red(bc))
+                return make(true, make(false, a->left, a->key, bc->left), bc->key, make(false, bc->right, b->key, b->right));
+            return balleft(a->left, a->key, make(false, std::move(bc), b->key, b->right));
+        }
+        if (b->red)
+            return make(true, append(a, b->left), b->key, b->right);
+        return make(true, a->left, a->key, append(a->right, b));
+    }
+
+    // Complejidad: O(log n) - copia el camino hasta la hoja nueva
+    node_ptr insert_rec(const node_ptr& s, const T& key) const {
+        if (!s) return make(true, nullptr, key, nullptr);
+        if (comp(key, s->key)) {
+            if (s->red) return make(true, insert_rec(s->left, key), s->key, s->right);
+            return balance(insert_rec(s->left, key), s->key, s->right);
+        }
+        if (s->red) return make(true, s->left, s->key, insert_rec(s->right, key));
+        return balance(s->left, s->key, insert_rec(s->right, key));
+    }
+
+    // Complejidad: O(log n) - copia el camino hasta el nodo borrado (la clave existe)
+    node_ptr erase_rec(const node_ptr& s, const T& key) const {
+        if (!s) return nullptr;
+        auto c = tree_compare(comp, key, s->key);
+        if (c < 0) {
+            if (is_black_node(s->left))
+                return balleft(erase_rec(s->left, key), s->key, s->right);
+            return make(true, erase_rec(s->left, key), s->key, s->right);
+        }
+        if (c > 0) {
+            if (is_black_node(s->right))
+                return balright(s->left, s->key, erase_rec(s->right, key));
+            return make(true, s->left, s->key, erase_rec(s->right, key));
+        }
+        return append(s->left, s->right);
+    }
+
+    template<typename K>
+    static const node* find_node(const Compare& comp, const node* x, const K& key) {
+        while (x) {
+            auto c = tree_compare(comp, key, x->key);
+            if (c < 0)
+                x = x->left.get();
+            else if (c > 0)
+                x = x->right.get();
+            else
+                return x;
+        }
+        return nullptr;
+    }
+
+public:
+    // Versión inmutable del árbol. Copiarla es O(1) (comparte la raíz) y mantiene
+    // vivos sus nodos aunque el árbol siga cambiando.
+    class snapshot_type {
+    private:
+        std::shared_ptr<const version> v;
+        [[no_unique_address]] Compare comp;
+        friend class PersistentRBTree;
+        snapshot_type(std::shared_ptr<const version> ver, const Compare& c) : v(std::move(ver)), comp(c) {}
+
+    public:
+        // Iterador hacia delante en orden. Sin punteros al padre: guarda el camino
+        // pendiente en una pila de O(log n) nodos. ++ es O(1) amortizado.
+        class const_iterator {
+        private:
+            std::vector<const node*> stack; // el tope es el nodo actual
+            friend class snapshot_type;
+            void push_left(const node* x) {
+                for (; x; x = x->left.get()) stack.push_back(x);
+            }
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T*;
+            using reference = const T&;
+
+            const_iterator() = default;
+            reference operator*() const { return stack.back()->key; }
+            pointer operator->() const { return &stack.back()->key; }
+            const_iterator& operator++() {
+                const node* x = stack.back();
+                stack.pop_back();
+                push_left(x->right.get());
+                return *this;
+            }
+            const_iterator operator++(int) {
+                const_iterator old = *this;
+                ++*this;
+                return old;
+            }
+            bool operator==(const const_iterator& o) const {
+                return stack.empty() ? o.stack.empty() : (!o.stack.empty() && stack.back() == o.stack.back());
+            }
+        };
+        using iterator = const_iterator;
+
+        // Complejidad: O(log n)
+        const_iterator begin() const {
+            const_iterator it;
+            it.push_left(v->root.get());
+            return it;
+        }
+        const_iterator end() const { return const_iterator(); }
+
+        // Complejidad: O(log n) - primer elemento con clave >= key
+        const_iterator lower_bound(const T& key) const {
+            const_iterator it;
+            for (const node* x = v->root.get(); x;) {
+                if (comp(x->key, key)) {
+                    x = x->right.get();
+                } else {
+                    it.stack.push_back(x); // pendiente: x y su subárbol derecho
+                    x = x->left.get();
+                }
+            }
+            return it;
+        }
+
+        // Complejidad: O(log n)
+        bool find(const T& key) const {
+            return find_node(comp, v->root.get(), key) != nullptr;
+        }
+        template<typename K> requires transparent_compare<Compare>
+        bool find(const K& key) const {
+            return find_node(comp, v->root.get(), key) != nullptr;
+        }
+
+        // Complejidad: O(1)
+        std::size_t size() const { return v->size; }
+        bool empty() const { return v->size == 0; }
+    };
+
+    // Complejidad: O(1)
+    PersistentRBTree() : current(std::make_shared<const version>()) {}
+    explicit PersistentRBTree(const Compare& c) : current(std::make_shared<const version>()), comp(c) {}
+
+    PersistentRBTree(const PersistentRBTree&) = delete;
+    PersistentRBTree& operator=(const PersistentRBTree&) = delete;
+
+    // Complejidad: O(log n) tiempo y nodos nuevos. Las versiones anteriores no cambian.
+    void add_leaf(const T& key) {
+        std::lock_guard lock(writer);
+        auto old = current.load(std::memory_order_relaxed);
+        auto next = std::make_shared<version>();
+        next->root = make_black(insert_rec(old->root, key));
+        next->size = old->size + 1;
+        current.store(std::move(next), std::memory_order_release);
+    }
+
+    // Complejidad: O(log n) tiempo y nodos nuevos; false (sin copiar nada) si la clave no está
+    bool delete_leaf(const T& key) {
+        std::lock_guard lock(writer);
+        auto old = current.load(std::memory_order_relaxed);
+        if (!find_node(comp, old->root.get(), key)) return false;
+        auto next = std::make_shared<version>();
+        node_ptr r = erase_rec(old->root, key);
+        next->root = r ? make_black(r) : nullptr;
+        next->size = old->size - 1;
+        current.store(std::move(next), std::memory_order_release);
+        return true;
+    }
+
+    // Complejidad: O(1) - versión actual, consistente e inmutable
+    snapshot_type snapshot() const {
+        return snapshot_type(current.load(std::memory_order_acquire), comp);
+    }
+
+    // Complejidad: O(log n) - sobre la versión actual
+    bool find(const T& key) const {
+        return snapshot().find(key);
+    }
+    template<typename K> requires transparent_compare<Compare>
+    bool find(const K& key) const {
+        return snapshot().find(key);
+    }
+
+    // Complejidad: O(1)
+    std::size_t size() const {
+        return current.load(std::memory_order_acquire)->size;
+    }
+    bool empty() const {
+        return size() == 0;
+    }
+
+    // Complejidad: O(1) - el árbol anterior se libera cuando lo suelte el último snapshot
+    void clear() {
+        std::lock_guard lock(writer);
+        current.store(std::make_shared<const version>(), std::memory_order_release);
+    }
+
+    // Nodos vivos de todos los PersistentRBTree<T, Compare> (versiones y snapshots incluidos)
+    static std::size_t live_nodes() {
+        return live.load(std::memory_order_relaxed);
+    }
+    // Bytes de un nodo sin contar el bloque de control que añade make_shared
+    static constexpr std::size_t node_bytes = sizeof(node);
+};
+#endif //PERSISTENT_RB_TREE_H
@@ -1,230 +1,1375 @@
-
 #ifndef RB_TREE_H
 #define RB_TREE_H
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
-template<typename T>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <vector>
+#ifdef RB_TREE_PARALLEL_SORT
+#include <execution>
+#endif
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "FrozenIndex.h"
+#include "NodePool.h"
+#include "TreeCompare.h"
+#include "TreePrefetch.h"
+#include "TreeSnapshot.h"
+#include "TreeStats.h"
+
+// ===== Aumentos de subárbol =====
+// Un aumento guarda en cada nodo un dato calculado a partir de su subárbol.
+// update() lo recalcula desde la clave del nodo y los datos de sus hijos (nullptr = hijo nulo);
+// el árbol lo llama tras cada rotación y en el camino modificado por add_leaf/delete_leaf.
+
+// Sin aumento: el campo es un struct vacío y no ocupa espacio en el nodo
+struct rb_no_augment {
+    struct data {};
+    static constexpr bool enabled = false;
+    template<typename T>
+    static void update(data&, const T&, const data*, const data*) {}
+};
+
+// Estadísticos de orden: tamaño de cada subárbol (habilita rank, select y count_range)
+struct rb_order_statistics {
+    struct data {
+        std::uint32_t size = 1;
+    };
+    static constexpr bool enabled = true;
+    template<typename T>
+    static void update(data& self, const T&, const data* l, const data* r) {
+        self.size = 1 + (l ? l->size : 0) + (r ? r->size : 0);
+    }
+};
+
+// Intervalos: cada clave es un intervalo cerrado [first, second] (std::pair<E, E> o
+// cualquier tipo con miembros first y second) y el árbol los ordena por su inicio.
+// Cada nodo guarda el mayor extremo final de su subárbol (habilita overlapping).
+// Los extremos se comparan con el operator< de E.
+template<typename E>
+struct rb_interval_max {
+    struct data {
+        E max_end{};
+    };
+    static constexpr bool enabled = true;
+    template<typename T>
+    static void update(data& self, const T& key, const data* l, const data* r) {
+        const E* m = &key.second;
+        if (l && *m < l->max_end) m = &l->max_end;
+        if (r && *m < r->max_end) m = &r->max_end;
+        self.max_end = *m;
+    }
+};
+
+// Agregados de un monoide sobre claves std::pair<K, V> (ver RB_aggregate_tree).
+// Un monoide define value_type, identity(), combine(a, b) (asociativa; no hace falta
+// que sea conmutativa: se combina siempre en orden de clave) y of(v), el valor de
+// un solo elemento a partir de su V. Cada nodo guarda la combinación de su subárbol.
+template<typename V>
+struct rb_sum_monoid {
+    using value_type = V;
+    static value_type identity() { return V{}; }
+    static value_type combine(const value_type& a, const value_type& b) { return a + b; }
+    static value_type of(const V& v) { return v; }
+};
+template<typename V>
+struct rb_min_monoid {
+    using value_type = V;
+    static value_type identity() { return std::numeric_limits<V>::max(); }
+    static value_type combine(const value_type& a, const value_type& b) { return b < a ? b : a; }
+    static value_type of(const V& v) { return v; }
+};
+template<typename V>
+struct rb_max_monoid {
+    using value_type = V;
+    static value_type identity() { return std::numeric_limits<V>::lowest(); }
+    static value_type combine(const value_type& a, const value_type& b) { return a < b ? b : a; }
+    static value_type of(const V& v) { return v; }
+};
+struct rb_count_monoid {
+    using value_type = std::size_t;
+    static value_type identity() { return 0; }
+    static value_type combine(value_type a, value_type b) { return a + b; }
+    template<typename V>
+    static value_type of(const V&) { return 1; }
+};
+// Monoide vacío: el árbol no guarda ningún agregado
+struct rb_no_monoid {
+    struct value_type {};
+    static value_type identity() { return {}; }
+    static value_type combine(value_type, value_type) { return {}; }
+    template<typename V>
+    static value_type of(const V&) { return {}; }
+};
+
+// Con un value_type vacío el aumento se desactiva y el campo no ocupa espacio en el nodo
+template<typename Monoid>
+struct rb_monoid_aggregate {
+    using monoid = Monoid;
+    using value_type = typename Monoid::value_type;
+    static constexpr bool enabled = !std::is_empty_v<value_type>;
+    struct stored {
+        value_type value = Monoid::identity();
+    };
+    using data = std::conditional_t<enabled, stored, rb_no_augment::data>;
+    template<typename T>
+    static void update(data& self, const T& key, const data* l, const data* r) {
+        if constexpr (enabled) {
+            value_type v = Monoid::of(key.second);
+            if (l) v = Monoid::combine(l->value, v);
+            if (r) v = Monoid::combine(v, r->value);
+            self.value = std::move(v);
+        }
+    }
+};
+
+// Orden de los pares (clave, valor) solo por la clave; transparente, para buscar con una K
+template<typename Compare>
+struct rb_first_less {
+    using is_transparent = void;
+    [[no_unique_address]] Compare comp;
+    template<typename A, typename B>
+    bool operator()(const A& a, const B& b) const { return comp(first_of(a), first_of(b)); }
+
+private:
+    template<typename A>
+    static const auto& first_of(const A& a) {
+        if constexpr (requires { a.first; }) return a.first;
+        else return a;
+    }
+};
+
+template<typename T, typename Extra = rb_no_augment::data>
 struct Node {
     Node* left;
     Node* right;
     Node* parent;
     T key;
     bool color; // false = black, true = red
-    Node(T k) {
-        left = nullptr;
-        right = nullptr;
-        parent = nullptr;
-        key = k;
-        color = true; // nuevo nodo siempre rojo
-    }
-    ~Node() {
-        if (left) delete left;
-        if (right) delete right;
-    }
+    [[no_unique_address]] Extra extra; // dato del aumento
+    // La clave se construye en el sitio (sin copias intermedias)
+    template<typename... Args>
+    explicit Node(Args&&... args)
+        : left(nullptr), right(nullptr), parent(nullptr), key(std::forward<Args>(args)...),
+          color(true) {} // nuevo nodo siempre rojo
 };
-template<typename T>
+
+// Nodo compacto: el color vive en el bit bajo del puntero al padre.
+// Con claves de 8 bytes (long, double...) ocupa 32 bytes en lugar de 40.
+template<typename T, typename Extra = rb_no_augment::data>
+struct RB_compact_node {
+    RB_compact_node* left;
+    RB_compact_node* right;
+    std::uintptr_t parent_color; // puntero al padre | bit de color (1 = rojo)
+    T key;
+    [[no_unique_address]] Extra extra;
+    template<typename... Args>
+    explicit RB_compact_node(Args&&... args)
+        : left(nullptr), right(nullptr), parent_color(1), key(std::forward<Args>(args)...) {}
+};
+
+// Nodo indexado: enlaces de 32 bits dentro de un index_pool.
+// El campo padre guarda (índice << 1) | color; con claves int ocupa 16 bytes.
+template<typename T, typename Extra = rb_no_augment::data>
+struct RB_index_node {
+    std::uint32_t left;
+    std::uint32_t right;
+    std::uint32_t parent_color;
+    T key;
+    [[no_unique_address]] Extra extra;
+    template<typename... Args>
+    explicit RB_index_node(std::uint32_t nil, Args&&... args)
+        : left(nil), right(nil), parent_color((nil << 1) | 1u), key(std::forward<Args>(args)...) {}
+};
+
+// ===== Layouts de nodo =====
+// Un layout decide cómo se guardan los enlaces y el color. El árbol solo accede a
+// los nodos a través de estas funciones, así que rotaciones, fixups y transplant
+// son los mismos para los tres layouts.
+
+// Layout original: tres punteros y un bool de color
+struct rb_pointer_layout {
+    template<typename T, typename Extra, template<typename> class Pool>
+    struct bind {
+        using node = Node<T, Extra>;
+        using pool_type = Pool<node>;
+        using handle = node*;
+        static constexpr handle nil = nullptr;
+
+        template<typename... Args>
+        static handle create(pool_type& pool, Args&&... args) { return pool.create(std::forward<Args>(args)...); }
+        static void destroy(pool_type& pool, handle x) { pool.destroy(x); }
+
+        static handle left(const pool_type&, handle x) { return x->left; }
+        static handle right(const pool_type&, handle x) { return x->right; }
+        static handle parent(const pool_type&, handle x) { return x->parent; }
+        static void set_left(const pool_type&, handle x, handle y) { x->left = y; }
+        static void set_right(const pool_type&, handle x, handle y) { x->right = y; }
+        static void set_parent(const pool_type&, handle x, handle p) { x->parent = p; }
+        static bool red(const pool_type&, handle x) { return x->color; }
+        static void set_red(const pool_type&, handle x, bool r) { x->color = r; }
+        static T& key(const pool_type&, handle x) { return x->key; }
+        static Extra& extra(const pool_type&, handle x) { return x->extra; }
+        static const void* address(const pool_type&, handle x) { return x; }
+    };
+};
+
+// Layout compacto con punteros: color empaquetado en el bit bajo de parent
+struct rb_compact_layout {
+    template<typename T, typename Extra, template<typename> class Pool>
+    struct bind {
+        using node = RB_compact_node<T, Extra>;
+        using pool_type = Pool<node>;
+        using handle = node*;
+        static constexpr handle nil = nullptr;
+        static_assert(alignof(node) >= 2, "el bit bajo del puntero al padre debe estar libre");
+
+        template<typename... Args>
+        static handle create(pool_type& pool, Args&&... args) { return pool.create(std::forward<Args>(args)...); }
+        static void destroy(pool_type& pool, handle x) { pool.destroy(x); }
+
+        static handle left(const pool_type&, handle x) { return x->left; }
+        static handle right(const pool_type&, handle x) { return x->right; }
+        static handle parent(const pool_type&, handle x) {
+            return reinterpret_cast<handle>(x->parent_color & ~std::uintptr_t(1));
+        }
+        static void set_left(const pool_type&, handle x, handle y) { x->left = y; }
+        static void set_right(const pool_type&, handle x, handle y) { x->right = y; }
+        static void set_parent(const pool_type&, handle x, handle p) {
+            x->parent_color = reinterpret_cast<std::uintptr_t>(p) | (x->parent_color & 1);
+        }
+        static bool red(const pool_type&, handle x) { return x->parent_color & 1; }
+        static void set_red(const pool_type&, handle x, bool r) {
+            x->parent_color = (x->parent_color & ~std::uintptr_t(1)) | std::uintptr_t(r);
+        }
+        static T& key(const pool_type&, handle x) { return x->key; }
+        static Extra& extra(const pool_type&, handle x) { return x->extra; }
+        static const void* address(const pool_type&, handle x) { return x; }
+    };
+};
+
+// Layout con índices de 32 bits: requiere un pool con at(i), como index_pool
+struct rb_index_layout {
+    template<typename T, typename Extra, template<typename> class Pool>
+    struct bind {
+        using node = RB_index_node<T, Extra>;
+        using pool_type = Pool<node>;
+        using handle = typename pool_type::index_type;
+        static constexpr handle nil = pool_type::nil;
+
+        template<typename... Args>
+        static handle create(pool_type& pool, Args&&... args) { return pool.create(nil, std::forward<Args>(args)...); }
+        static void destroy(pool_type& pool, handle x) { pool.destroy(x); }
+
+        static handle left(const pool_type& pool, handle x) { return pool.at(x).left; }
+        static handle right(const pool_type& pool, handle x) { return pool.at(x).right; }
+        static handle parent(const pool_type& pool, handle x) { return pool.at(x).parent_color >> 1; }
+        static void set_left(const pool_type& pool, handle x, handle y) { pool.at(x).left = y; }
+        static void set_right(const pool_type& pool, handle x, handle y) { pool.at(x).right = y; }
+        static void set_parent(const pool_type& pool, handle x, handle p) {
+            node& n = pool.at(x);
+            n.parent_color = (p << 1) | (n.parent_color & 1u);
+        }
+        static bool red(const pool_type& pool, handle x) { return pool.at(x).parent_color & 1u; }
+        static void set_red(const pool_type& pool, handle x, bool r) {
+            node& n = pool.at(x);
+            n.parent_color = (n.parent_color & ~1u) | std::uint32_t(r);
+        }
+        static T& key(const pool_type& pool, handle x) { return pool.at(x).key; }
+        static Extra& extra(const pool_type& pool, handle x) { return pool.at(x).extra; }
+        static const void* address(const pool_type& pool, handle x) { return &pool.at(x); }
+    };
+};
+
+// Orden en que compact() coloca los nodos en memoria:
+//  - preorder: cada nodo seguido de su subárbol izquierdo (un descenso que gira a la
+//    izquierda sigue en memoria contigua)
+//  - van_emde_boas: la mitad superior del árbol primero y después cada subárbol de la
+//    mitad inferior, recursivamente; un descenso toca O(log_B n) bloques de B nodos
+//    sea cual sea el tamaño de la línea de caché o de la página
+enum class rb_node_order { preorder, van_emde_boas };
+
+// Compare: orden estricto débil de las claves (std::less<T> por defecto; std::less<>
+//          habilita búsquedas heterogéneas)
+// Pool: política de reserva de nodos (slab_pool por defecto, heap_pool = new/delete por nodo)
+// Layout: representación del nodo (rb_pointer_layout, rb_compact_layout o rb_index_layout)
+// Augment: dato de subárbol mantenido en cada nodo (rb_no_augment, rb_order_statistics,
+//          rb_interval_max o rb_monoid_aggregate)
+// Stats: instrumentación (tree_no_stats, sin coste, o tree_stats; ver TreeStats.h).
+// Los contadores son un solo miembro sin sincronizar: con Stats::enabled las
+// operaciones de conjuntos con parallel = true se ejecutan en serie.
+template<typename T, typename Compare = std::less<T>, template<typename> class Pool = slab_pool,
+         typename Layout = rb_pointer_layout, typename Augment = rb_no_augment, typename Stats = tree_no_stats>
 class RB_tree {
 private:
-    Node<T>* root;
+    using augment_data = typename Augment::data;
+    using layout = typename Layout::template bind<T, augment_data, Pool>;
+    using node_ptr = typename layout::handle;
+    static constexpr node_ptr nil = layout::nil;
 
-    // Complejidad: O(1) - operaciones de punteros constantes
-    void left_rotation(Node<T>* x) {
-        Node<T>* y = x->right;
-        x->right = y->left;
-        if (y->left != nullptr)
-            y->left->parent = x;
-        y->parent = x->parent;
-        if (x->parent == nullptr)
-            root = y;
-        else if (x == x->parent->left)
-            x->parent->left = y;
+    node_ptr root;
+    node_ptr leftmost = nil;  // mínimo cacheado: begin() en O(1)
+    node_ptr rightmost = nil; // máximo cacheado: --end() en O(1)
+    std::size_t node_count = 0;
+    typename layout::pool_type pool;
+    [[no_unique_address]] Compare comp;
+    // mutable: también cuentan los descensos de find, que es const
+    [[no_unique_address]] mutable Stats counters;
+    // Compactación incremental en curso (compact_step): siguiente nodo del recorrido
+    // en preorden y cuántos nodos quedan aún en los slabs viejos del pool
+    node_ptr compact_cursor = nil;
+    std::size_t compact_pending = 0;
+
+    // true si el pool puede abrir una región nueva (slab_pool): habilita compact_step
+    static constexpr bool incremental_compaction =
+        requires(typename layout::pool_type& p) { p.begin_fresh_region(); };
+
+    // Accesores del layout: O(1)
+    node_ptr left(node_ptr x) const { return layout::left(pool, x); }
+    node_ptr right(node_ptr x) const { return layout::right(pool, x); }
+    node_ptr parent(node_ptr x) const { return layout::parent(pool, x); }
+    void set_left(node_ptr x, node_ptr y) { layout::set_left(pool, x, y); }
+    void set_right(node_ptr x, node_ptr y) { layout::set_right(pool, x, y); }
+    void set_parent(node_ptr x, node_ptr p) { layout::set_parent(pool, x, p); }
+    // Un hijo nulo cuenta como negro
+    bool is_red(node_ptr x) const { return x != nil && layout::red(pool, x); }
+    void set_red(node_ptr x, bool r) { layout::set_red(pool, x, r); }
+    T& key(node_ptr x) const { return layout::key(pool, x); }
+    augment_data& extra(node_ptr x) const { return layout::extra(pool, x); }
+
+    // Complejidad: O(1) - recalcula el dato aumentado de x a partir de sus hijos
+    void update(node_ptr x) {
+        if constexpr (Augment::enabled) {
+            node_ptr l = left(x), r = right(x);
+            Augment::update(extra(x), key(x), l != nil ? &extra(l) : nullptr, r != nil ? &extra(r) : nullptr);
+        }
+    }
+
+    // Complejidad: O(log n) - recalcula el dato aumentado desde x hasta la raíz
+    void update_path(node_ptr x) {
+        if constexpr (Augment::enabled) {
+            while (x != nil) {
+                update(x);
+                x = parent(x);
+            }
+        }
+    }
+
+    // Tamaño del subárbol (solo con rb_order_statistics); 0 para el hijo nulo
+    std::size_t subtree_size(node_ptr x) const {
+        return x == nil ? 0 : extra(x).size;
+    }
+
+    // Complejidad: O(log n + k) - informa en orden de los k intervalos del subárbol de x que
+    // cortan [a, b]. Se descarta un subárbol si su mayor extremo final queda antes de a,
+    // y el subárbol derecho si el inicio del nodo ya pasa de b (los de la derecha empiezan
+    // después)
+    template<typename E, typename F>
+    std::size_t overlapping_in(node_ptr x, const E& a, const E& b, F& callback) const {
+        std::size_t found = 0;
+        while (x != nil && !(extra(x).max_end < a)) {
+            found += overlapping_in(left(x), a, b, callback);
+            const T& k = key(x);
+            if (b < k.first) break;
+            if (!(k.second < a)) {
+                callback(k);
+                ++found;
+            }
+            x = right(x); // el descenso por la derecha es iterativo
+        }
+        return found;
+    }
+
+    // Complejidad: O(k) - como destroy_subtree, pero devuelve los k nodos destruidos
+    std::size_t destroy_counted(node_ptr node) {
+        if (node == nil) return 0;
+        std::size_t k = destroy_counted(left(node)) + destroy_counted(right(node));
+        layout::destroy(pool, node);
+        return k + 1;
+    }
+
+    // Complejidad: O(n) - devuelve cada nodo del subárbol al pool en postorden
+    void destroy_subtree(node_ptr node) {
+        if (node == nil) return;
+        destroy_subtree(left(node));
+        destroy_subtree(right(node));
+        layout::destroy(pool, node);
+    }
+
+    // Complejidad: O(n) - construye un árbol perfectamente balanceado a partir de
+    // first[lo, hi) ordenado. Todos los niveles por encima de red_depth quedan
+    // completos, así que basta pintar de rojo el último nivel (incompleto) para
+    // que todos los caminos tengan la misma altura negra.
+    // Los nodos se crean en preorden: la parte alta del árbol queda contigua en el pool.
+    template<typename RandIt>
+    node_ptr build_balanced(RandIt first, std::size_t lo, std::size_t hi, int depth, int red_depth, node_ptr parent) {
+        if (lo >= hi) return nil;
+        std::size_t mid = lo + (hi - lo) / 2;
+        node_ptr x = layout::create(pool, first[mid]);
+        set_parent(x, parent);
+        set_red(x, depth == red_depth);
+        set_left(x, build_balanced(first, lo, mid, depth + 1, red_depth, x));
+        set_right(x, build_balanced(first, mid + 1, hi, depth + 1, red_depth, x));
+        update(x);
+        return x;
+    }
+
+    // Complejidad: O(n) - reemplaza el contenido por las n claves ordenadas de [first, last)
+    template<typename RandIt>
+    void build_from_sorted(RandIt first, RandIt last) {
+        clear();
+        std::size_t n = static_cast<std::size_t>(last - first);
+        if (n == 0) return;
+        // Profundidad del último nivel incompleto (si n + 1 es potencia de 2 no hay ninguno)
+        int red_depth = std::bit_width(n + 1) - 1;
+        root = build_balanced(first, 0, n, 0, red_depth, nil);
+        leftmost = minimum(root);
+        rightmost = maximum(root);
+        node_count = n;
+    }
+
+    // Forma guardada por save(with_shape): 4 bits por nodo en preorden (TreeSnapshot.h)
+    static unsigned shape_bits(const std::uint8_t* shape, std::size_t i) {
+        return (shape[i / 2] >> (4 * (i % 2))) & 0xFu;
+    }
+
+    // Complejidad: O(n) - escribe la forma del subárbol x a partir del nodo i
+    void collect_shape(node_ptr x, std::vector<std::uint8_t>& shape, std::size_t& i) const {
+        if (x == nil) return;
+        unsigned bits = (left(x) != nil ? 1u : 0u) | (right(x) != nil ? 2u : 0u) | (is_red(x) ? 4u : 0u);
+        shape[i / 2] = static_cast<std::uint8_t>(shape[i / 2] | (bits << (4 * (i % 2))));
+        ++i;
+        collect_shape(left(x), shape, i);
+        collect_shape(right(x), shape, i);
+    }
+
+    // Complejidad: O(n) - recorre una forma leída de un archivo sin crear nodos.
+    // Devuelve la altura negra del subárbol que empieza en el nodo i, o -1 si la forma
+    // no es un árbol rojo-negro válido de n nodos (rojo con hijo rojo, alturas negras
+    // distintas, más nodos de los que hay o más profundidad de la posible)
+    static int shape_black_height(const std::uint8_t* shape, std::size_t n, std::size_t& i, bool parent_red, int depth) {
+        if (i == n || depth > 128) return -1;
+        unsigned bits = shape_bits(shape, i++);
+        bool red = (bits & 4u) != 0;
+        if (red && parent_red) return -1;
+        int l = (bits & 1u) ? shape_black_height(shape, n, i, red, depth + 1) : 0;
+        if (l < 0) return -1;
+        int r = (bits & 2u) ? shape_black_height(shape, n, i, red, depth + 1) : 0;
+        if (r != l) return -1;
+        return l + (red ? 0 : 1);
+    }
+
+    // Complejidad: O(n) - reconstruye el subárbol guardado: los nodos se crean en
+    // preorden (como build_balanced) y cada uno recibe su clave en inorden, cuando
+    // ya se ha construido su hijo izquierdo. La forma debe estar validada.
+    node_ptr build_shaped(const std::uint8_t* shape, const T* keys, std::size_t& i, std::size_t& k, node_ptr parent) {
+        unsigned bits = shape_bits(shape, i++);
+        node_ptr x = layout::create(pool, keys[k]);
+        set_parent(x, parent);
+        set_red(x, (bits & 4u) != 0);
+        set_left(x, (bits & 1u) ? build_shaped(shape, keys, i, k, x) : nil);
+        key(x) = keys[k++];
+        set_right(x, (bits & 2u) ? build_shaped(shape, keys, i, k, x) : nil);
+        update(x);
+        return x;
+    }
+
+    // Complejidad: O(1) - operaciones de punteros constantes.
+    // top es la raíz del (sub)árbol en el que se rota: root, o la raíz local de
+    // un subárbol suelto en join/split
+    void left_rotation(node_ptr x, node_ptr& top) {
+        counters.rotation();
+        node_ptr y = right(x);
+        set_right(x, left(y));
+        if (left(y) != nil)
+            set_parent(left(y), x);
+        node_ptr xp = parent(x);
+        set_parent(y, xp);
+        if (xp == nil)
+            top = y;
+        else if (x == left(xp))
+            set_left(xp, y);
         else
-            x->parent->right = y;
-        y->left = x;
-        x->parent = y;
+            set_right(xp, y);
+        set_left(y, x);
+        set_parent(x, y);
+        // x quedó debajo de y: se recalcula primero x y después y
+        update(x);
+        update(y);
     }
 
     // Complejidad: O(1) - operaciones de punteros constantes
-    void right_rotation(Node<T>* y) {
-        Node<T>* x = y->left;
-        y->left = x->right;
-        if (x->right != nullptr)
-            x->right->parent = y;
-        x->parent = y->parent;
-        if (y->parent == nullptr)
-            root = x;
-        else if (y == y->parent->left)
-            y->parent->left = x;
+    void right_rotation(node_ptr y, node_ptr& top) {
+        counters.rotation();
+        node_ptr x = left(y);
+        set_left(y, right(x));
+        if (right(x) != nil)
+            set_parent(right(x), y);
+        node_ptr yp = parent(y);
+        set_parent(x, yp);
+        if (yp == nil)
+            top = x;
+        else if (y == left(yp))
+            set_left(yp, x);
         else
-            y->parent->right = x;
-        x->right = y;
-        y->parent = x;
+            set_right(yp, x);
+        set_right(x, y);
+        set_parent(y, x);
+        update(y);
+        update(x);
     }
 
     // Complejidad: O(log n) - recorre la altura del árbol que está balanceado
     // El número de rotaciones es constante (máximo 2), pero el recorrido hacia arriba es O(log n)
     // Proceso de fix-up en dos fases: inserción inicial + verificación ascendente
-    void add_leaf_fixup(Node<T>* k) {
-        while (k != root && k->parent->color == true) {
-            if (k->parent == k->parent->parent->left) {
-                Node<T>* u = k->parent->parent->right; // tío
-                if (u != nullptr && u->color == true) {
+    // top: raíz del (sub)árbol, ver left_rotation. Devuelve true si top acabó
+    // rojo y se pintó de negro (la altura negra del subárbol creció en uno)
+    bool add_leaf_fixup(node_ptr k, node_ptr& top) {
+        std::size_t steps = 0;
+        while (k != top && is_red(parent(k))) {
+            ++steps;
+            node_ptr p = parent(k);
+            node_ptr g = parent(p);
+            if (p == left(g)) {
+                node_ptr u = right(g); // tío
+                if (is_red(u)) {
                     // Caso 1: Padre y tío son rojos
                     // Recolorear padre y tío a negro, abuelo a rojo, continuar desde abuelo
-                    k->parent->color = false;
-                    u->color = false;
-                    k->parent->parent->color = true;
-                    k = k->parent->parent;
+                    counters.insert_case(1);
+                    set_red(p, false);
+                    set_red(u, false);
+                    set_red(g, true);
+                    k = g;
                 } else {
-                    if (k == k->parent->right) {
+                    if (k == right(p)) {
                         // Caso 2: Padre rojo, tío negro, k es hijo derecho
                         // Rotación izquierda sobre padre para convertir en Caso 3
-                        k = k->parent;
-                        left_rotation(k);
+                        counters.insert_case(2);
+                        k = p;
+                        left_rotation(k, top);
+                        p = parent(k);
                     }
                     // Caso 3: Padre rojo, tío negro, k es hijo izquierdo
                     // Rotación derecha sobre abuelo y recolorear
-                    k->parent->color = false;
-                    k->parent->parent->color = true;
-                    right_rotation(k->parent->parent);
+                    counters.insert_case(3);
+                    set_red(p, false);
+                    set_red(g, true);
+                    right_rotation(g, top);
                 }
             } else {
-                Node<T>* u = k->parent->parent->left; // tío
-                if (u != nullptr && u->color == true) {
+                node_ptr u = left(g); // tío
+                if (is_red(u)) {
                     // Caso 1: Padre y tío son rojos (simétrico)
-                    k->parent->color = false;
-                    u->color = false;
-                    k->parent->parent->color = true;
-                    k = k->parent->parent;
+                    counters.insert_case(1);
+                    set_red(p, false);
+                    set_red(u, false);
+                    set_red(g, true);
+                    k = g;
                 } else {
-                    if (k == k->parent->left) {
+                    if (k == left(p)) {
                         // Caso 2: Padre rojo, tío negro, k es hijo izquierdo (simétrico)
                         // Rotación derecha sobre padre para convertir en Caso 3
-                        k = k->parent;
-                        right_rotation(k);
+                        counters.insert_case(2);
+                        k = p;
+                        right_rotation(k, top);
+                        p = parent(k);
                     }
                     // Caso 3: Padre rojo, tío negro, k es hijo derecho (simétrico)
                     // Rotación izquierda sobre abuelo y recolorear
-                    k->parent->color = false;
-                    k->parent->parent->color = true;
-                    left_rotation(k->parent->parent);
+                    counters.insert_case(3);
+                    set_red(p, false);
+                    set_red(g, true);
+                    left_rotation(g, top);
                 }
             }
         }
-        root->color = false;
+        counters.fixup_steps(steps);
+        bool grew = is_red(top);
+        set_red(top, false);
+        return grew;
     }
 
     // Complejidad: O(log n) - similar a add_leaf_fixup, recorre la altura del árbol
-    void delete_leaf_fixup(Node<T>* x, Node<T>* x_parent) {
-        while (x != root && (x == nullptr || x->color == false)) {
-            if (x == x_parent->left) {
-                Node<T>* w = x_parent->right;
-                if (w->color == true) {
-                    w->color = false;
-                    x_parent->color = true;
-                    left_rotation(x_parent);
-                    w = x_parent->right;
+    // Casos (para la instrumentación): 1 hermano rojo, 2 hermano negro con hijos
+    // negros (recoloreo y se sube), 3 sobrino lejano negro, 4 rotación final
+    void delete_leaf_fixup(node_ptr x, node_ptr x_parent) {
+        std::size_t steps = 0;
+        while (x != root && !is_red(x)) {
+            ++steps;
+            if (x == left(x_parent)) {
+                node_ptr w = right(x_parent);
+                if (is_red(w)) {
+                    counters.delete_case(1);
+                    set_red(w, false);
+                    set_red(x_parent, true);
+                    left_rotation(x_parent, root);
+                    w = right(x_parent);
                 }
-                if ((w->left == nullptr || w->left->color == false) &&
-                    (w->right == nullptr || w->right->color == false)) {
-                    w->color = true;
+                if (!is_red(left(w)) && !is_red(right(w))) {
+                    counters.delete_case(2);
+                    set_red(w, true);
                     x = x_parent;
-                    x_parent = x->parent;
+                    x_parent = parent(x);
                 } else {
-                    if (w->right == nullptr || w->right->color == false) {
-                        if (w->left) w->left->color = false;
-                        w->color = true;
-                        right_rotation(w);
-                        w = x_parent->right;
+                    if (!is_red(right(w))) {
+                        counters.delete_case(3);
+                        if (left(w) != nil) set_red(left(w), false);
+                        set_red(w, true);
+                        right_rotation(w, root);
+                        w = right(x_parent);
                     }
-                    w->color = x_parent->color;
-                    x_parent->color = false;
-                    if (w->right) w->right->color = false;
-                    left_rotation(x_parent);
+                    counters.delete_case(4);
+                    set_red(w, is_red(x_parent));
+                    set_red(x_parent, false);
+                    if (right(w) != nil) set_red(right(w), false);
+                    left_rotation(x_parent, root);
                     x = root;
                 }
             } else {
-                Node<T>* w = x_parent->left;
-                if (w->color == true) {
-                    w->color = false;
-                    x_parent->color = true;
-                    right_rotation(x_parent);
-                    w = x_parent->left;
+                node_ptr w = left(x_parent);
+                if (is_red(w)) {
+                    counters.delete_case(1);
+                    set_red(w, false);
+                    set_red(x_parent, true);
+                    right_rotation(x_parent, root);
+                    w = left(x_parent);
                 }
-                if ((w->right == nullptr || w->right->color == false) &&
-                    (w->left == nullptr || w->left->color == false)) {
-                    w->color = true;
+                if (!is_red(right(w)) && !is_red(left(w))) {
+                    counters.delete_case(2);
+                    set_red(w, true);
                     x = x_parent;
-                    x_parent = x->parent;
+                    x_parent = parent(x);
                 } else {
-                    if (w->left == nullptr || w->left->color == false) {
-                        if (w->right) w->right->color = false;
-                        w->color = true;
-                        left_rotation(w);
-                        w = x_parent->left;
+                    if (!is_red(left(w))) {
+                        counters.delete_case(3);
+                        if (right(w) != nil) set_red(right(w), false);
+                        set_red(w, true);
+                        left_rotation(w, root);
+                        w = left(x_parent);
                     }
-                    w->color = x_parent->color;
-                    x_parent->color = false;
-                    if (w->left) w->left->color = false;
-                    right_rotation(x_parent);
+                    counters.delete_case(4);
+                    set_red(w, is_red(x_parent));
+                    set_red(x_parent, false);
+                    if (left(w) != nil) set_red(left(w), false);
+                    right_rotation(x_parent, root);
                     x = root;
                 }
             }
         }
-        if (x) x->color = false;
+        counters.fixup_steps(steps);
+        if (x != nil) set_red(x, false);
     }
 
     // Complejidad: O(log n) - recorre desde un nodo hasta el mínimo de su subárbol
     // En el peor caso, recorre toda la altura del subárbol
-    Node<T>* minimum(Node<T>* node) {
-        while (node->left != nullptr)
-            node = node->left;
+    node_ptr minimum(node_ptr node) const {
+        while (left(node) != nil)
+            node = left(node);
         return node;
     }
 
     // Complejidad: O(log n) - recorre desde un nodo hasta el máximo de su subárbol
-    Node<T>* maximum(Node<T>* node) {
-        while (node->right != nullptr)
-            node = node->right;
+    node_ptr maximum(node_ptr node) const {
+        while (right(node) != nil)
+            node = right(node);
         return node;
     }
 
-    // Complejidad: O(log n) - búsqueda binaria en árbol balanceado
-    Node<T>* find_node(T key) {
-        Node<T>* current = root;
-        while (current != nullptr) {
-            if (key == current->key)
-                return current;
-            else if (key < current->key)
-                current = current->left;
+    // Complejidad: O(1) amortizado al recorrer todo el árbol, O(log n) en el peor caso
+    // Sucesor inorden usando los punteros al padre; nil si node es el máximo
+    node_ptr next_node(node_ptr node) const {
+        if (right(node) != nil)
+            return minimum(right(node));
+        node_ptr p = parent(node);
+        while (p != nil && node == right(p)) {
+            node = p;
+            p = parent(p);
+        }
+        return p;
+    }
+
+    // Complejidad: igual que next_node - predecesor inorden; nil si node es el mínimo
+    node_ptr prev_node(node_ptr node) const {
+        if (left(node) != nil)
+            return maximum(left(node));
+        node_ptr p = parent(node);
+        while (p != nil && node == left(p)) {
+            node = p;
+            p = parent(p);
+        }
+        return p;
+    }
+
+    template<typename A, typename B>
+    bool less(const A& a, const B& b) const {
+        return comp(a, b);
+    }
+
+    // Complejidad: O(log n) - primer nodo con clave >= key (nil si no hay)
+    template<typename K>
+    node_ptr lower_bound_node(const K& key) const {
+        node_ptr current = root;
+        node_ptr result = nil;
+        while (current != nil) {
+            if (less(this->key(current), key)) {
+                current = right(current);
+            } else {
+                result = current;
+                current = left(current);
+            }
+        }
+        return result;
+    }
+
+    // Complejidad: O(log n) - primer nodo con clave > key (nil si no hay)
+    template<typename K>
+    node_ptr upper_bound_node(const K& key) const {
+        node_ptr current = root;
+        node_ptr result = nil;
+        while (current != nil) {
+            if (less(key, this->key(current))) {
+                result = current;
+                current = left(current);
+            } else {
+                current = right(current);
+            }
+        }
+        return result;
+    }
+
+    // Complejidad: O(log n) - búsqueda binaria en árbol balanceado.
+    // Una comparación de tres vías por nivel (ver tree_compare)
+    template<typename K>
+    node_ptr find_node(const K& key) const {
+        node_ptr current = root;
+        std::size_t depth = 0;
+        while (current != nil) {
+            ++depth;
+            auto c = tree_compare(comp, key, this->key(current));
+            if (c < 0)
+                current = left(current);
+            else if (c > 0)
+                current = right(current);
             else
-                current = current->right;
+                break;
+        }
+        counters.search_path(depth);
+        return current;
+    }
+
+    // Complejidad: O(log n) - descenso de find_node que se rinde tras max_depth niveles.
+    // Lo usan las lecturas optimistas de ConcurrentRBTree: con un escritor a la vez
+    // el camino puede estar a medio rotar, así que el resultado solo vale si la
+    // versión no cambió. 1 = encontrada, 0 = no está, -1 = descenso abortado
+    template<typename K>
+    int find_bounded(const K& key, std::size_t max_depth) const {
+        node_ptr current = root;
+        for (std::size_t depth = 0; current != nil; ++depth) {
+            if (depth == max_depth) return -1;
+            auto c = tree_compare(comp, key, this->key(current));
+            if (c < 0)
+                current = left(current);
+            else if (c > 0)
+                current = right(current);
+            else
+                return 1;
+        }
+        return 0;
+    }
+
+    // Complejidad: O(log n) + fixup - enlaza el nodo ya creado z como hijo de parent
+    // (raíz si parent es nil), mantiene extremos, tamaño y aumento, y rebalancea
+    void link_node(node_ptr z, node_ptr parent, bool as_left) {
+        set_parent(z, parent);
+        if (parent == nil) {
+            root = leftmost = rightmost = z;
+        } else if (as_left) {
+            set_left(parent, z);
+            if (parent == leftmost) leftmost = z;
+        } else {
+            set_right(parent, z);
+            if (parent == rightmost) rightmost = z;
+        }
+        ++node_count;
+        update_path(z); // dato de hoja de z (el valor por defecto no vale para todo aumento) y su camino
+        // Rebalanceo: O(log n)
+        add_leaf_fixup(z, root);
+    }
+
+    // Complejidad: O(log n) - inserción con duplicados (van al subárbol derecho).
+    // Una clave >= que el máximo o < que el mínimo se cuelga directamente del extremo
+    // cacheado: con claves que llegan en orden (marcas de tiempo) no hay descenso y
+    // solo queda el fixup, O(1) amortizado.
+    void insert_equal_node(node_ptr new_node) {
+        const T& key = this->key(new_node);
+        if (rightmost != nil && !less(key, this->key(rightmost))) {
+            counters.search_path(1);
+            link_node(new_node, rightmost, false);
+            return;
+        }
+        if (leftmost != nil && less(key, this->key(leftmost))) {
+            counters.search_path(1);
+            link_node(new_node, leftmost, true);
+            return;
+        }
+        node_ptr parent = nil;
+        node_ptr current = root;
+        bool as_left = false;
+        std::size_t depth = 0;
+        // Búsqueda de posición: O(log n)
+        while (current != nil) {
+            ++depth;
+            parent = current;
+            as_left = less(key, this->key(current));
+            current = as_left ? left(current) : right(current);
         }
-        return nullptr;
+        counters.search_path(depth);
+        link_node(new_node, parent, as_left);
+    }
+
+    // Complejidad: O(log n) - un único descenso con una comparación por nivel.
+    // candidate es el último nodo donde se bajó a la derecha, es decir, la mayor
+    // clave <= key del árbol: si no es estrictamente menor, key ya está.
+    // Devuelve {nodo existente, nil} o {nil, padre del hueco} y as_left.
+    // Una clave mayor que el máximo (o menor que el mínimo) va junto al extremo cacheado
+    // sin descender, como en insert_equal_node.
+    template<typename K>
+    std::pair<node_ptr, node_ptr> find_unique_slot(const K& key, bool& as_left) const {
+        if (rightmost != nil && less(this->key(rightmost), key)) {
+            counters.search_path(1);
+            as_left = false;
+            return {nil, rightmost};
+        }
+        if (leftmost != nil && less(key, this->key(leftmost))) {
+            counters.search_path(1);
+            as_left = true;
+            return {nil, leftmost};
+        }
+        node_ptr parent = nil;
+        node_ptr current = root;
+        node_ptr candidate = nil;
+        std::size_t depth = 0;
+        as_left = false;
+        while (current != nil) {
+            ++depth;
+            parent = current;
+            as_left = less(key, this->key(current));
+            if (as_left) {
+                current = left(current);
+            } else {
+                candidate = current;
+                current = right(current);
+            }
+        }
+        counters.search_path(depth);
+        if (candidate != nil && !less(this->key(candidate), key))
+            return {candidate, nil};
+        return {nil, parent};
+    }
+
+    // Complejidad: O(1) amortizado + fixup si key cabe justo antes de hint (entre su
+    // predecesor y él); si no, O(log n) como insert_equal_node. hint == end() equivale
+    // a insertar detrás del máximo.
+    void insert_hint_node(node_ptr hint, node_ptr z) {
+        const T& key = this->key(z);
+        if (hint == nil || less(this->key(hint), key)) {
+            insert_equal_node(z); // también cubre hint == end(): z va detrás del máximo
+            return;
+        }
+        node_ptr prev = prev_node(hint);
+        if (prev != nil && less(key, this->key(prev))) {
+            insert_equal_node(z);
+            return;
+        }
+        counters.search_path(1);
+        // Si hint tiene hijo izquierdo, su predecesor es el máximo de ese subárbol y no
+        // tiene hijo derecho; si no, el hueco es el hijo izquierdo de hint
+        if (left(hint) == nil)
+            link_node(z, hint, true);
+        else
+            link_node(z, prev, false);
+    }
+
+    // Complejidad: O(log n) - quita z del árbol, lo devuelve al pool y rebalancea
+    void erase_node(node_ptr z) {
+        if constexpr (incremental_compaction)
+            if (pool.in_fresh_region()) {
+                if (z == compact_cursor) compact_cursor = preorder_next(z);
+                if (pool.in_old_region(layout::address(pool, z))) --compact_pending;
+            }
+        // Los extremos cacheados se actualizan antes de tocar la estructura.
+        // Si z es el mínimo no tiene hijo izquierdo (y si es el máximo, no tiene derecho).
+        if (z == leftmost)
+            leftmost = right(z) != nil ? minimum(right(z)) : parent(z);
+        if (z == rightmost)
+            rightmost = left(z) != nil ? maximum(left(z)) : parent(z);
+        node_ptr y = z;
+        node_ptr x;
+        node_ptr x_parent;
+        bool y_original_color = is_red(y);
+        if (left(z) == nil) {
+            x = right(z);
+            x_parent = parent(z);
+            transplant(z, right(z));
+        } else if (right(z) == nil) {
+            x = left(z);
+            x_parent = parent(z);
+            transplant(z, left(z));
+        } else {
+            y = minimum(right(z)); // O(log n)
+            y_original_color = is_red(y);
+            x = right(y);
+            if (parent(y) == z) {
+                x_parent = y;
+            } else {
+                x_parent = parent(y);
+                transplant(y, right(y));
+                set_right(y, right(z));
+                set_parent(right(y), y);
+            }
+            transplant(z, y);
+            set_left(y, left(z));
+            set_parent(left(y), y);
+            set_red(y, is_red(z));
+        }
+        layout::destroy(pool, z); // el hueco vuelve a la lista libre del pool
+        --node_count;
+        // x_parent es el nodo más bajo cuyo subárbol cambió (y, si subió, está en este camino)
+        update_path(x_parent);
+        if (y_original_color == false)
+            delete_leaf_fixup(x, x_parent); // O(log n)
     }
 
     // Complejidad: O(1) - solo actualiza punteros
-    void transplant(Node<T>* u, Node<T>* v) {
-        if (u->parent == nullptr)
+    void transplant(node_ptr u, node_ptr v) {
+        node_ptr up = parent(u);
+        if (up == nil)
             root = v;
-        else if (u == u->parent->left)
-            u->parent->left = v;
+        else if (u == left(up))
+            set_left(up, v);
         else
-            u->parent->right = v;
-        if (v != nullptr)
-            v->parent = u->parent;
+            set_right(up, v);
+        if (v != nil)
+            set_parent(v, up);
+    }
+
+    // ===== join / split =====
+    // Subárbol suelto: raíz negra sin padre y su altura negra (nodos negros en
+    // cualquier camino de la raíz a un hijo nulo, incluida la raíz). Conocer la
+    // altura negra permite unir dos subárboles en O(diferencia de alturas).
+    struct subtree {
+        node_ptr root;
+        int bh;
+    };
+
+    // Complejidad: O(log n) - altura negra por el camino izquierdo
+    int black_height(node_ptr x) const {
+        int h = 0;
+        for (; x != nil; x = left(x))
+            if (!is_red(x)) ++h;
+        return h;
+    }
+
+    // Complejidad: O(1) - suelta x (hijo de un nodo negro de altura bh + 1) de su
+    // padre; si era rojo se pinta de negro y su altura negra sube en uno
+    subtree detach(node_ptr x, int bh) {
+        if (x == nil) return {nil, 0};
+        set_parent(x, nil);
+        if (is_red(x)) {
+            set_red(x, false);
+            ++bh;
+        }
+        return {x, bh};
+    }
+
+    // Complejidad: O(|l.bh - r.bh| + 1) más el fixup - une l, el nodo suelto k y r,
+    // con todas las claves de l <= key(k) <= las de r. Si las alturas coinciden, k es
+    // la nueva raíz; si no, baja por el borde del más alto hasta un nodo negro de la
+    // altura del otro, cuelga k (rojo) ahí y reutiliza add_leaf_fixup con esa raíz local.
+    subtree join(subtree l, node_ptr k, subtree r) {
+        if (l.bh == r.bh) {
+            set_left(k, l.root);
+            set_right(k, r.root);
+            if (l.root != nil) set_parent(l.root, k);
+            if (r.root != nil) set_parent(r.root, k);
+            set_parent(k, nil);
+            set_red(k, false);
+            update(k);
+            return {k, l.bh + 1};
+        }
+        node_ptr top, p = nil;
+        int bh;
+        if (l.bh > r.bh) {
+            top = l.root;
+            bh = l.bh;
+            node_ptr c = l.root;
+            for (int h = l.bh; is_red(c) || h > r.bh; c = right(c)) {
+                if (!is_red(c)) --h;
+                p = c;
+            }
+            set_left(k, c);
+            if (c != nil) set_parent(c, k);
+            set_right(k, r.root);
+            if (r.root != nil) set_parent(r.root, k);
+            set_right(p, k);
+        } else {
+            top = r.root;
+            bh = r.bh;
+            node_ptr c = r.root;
+            for (int h = r.bh; is_red(c) || h > l.bh; c = left(c)) {
+                if (!is_red(c)) --h;
+                p = c;
+            }
+            set_right(k, c);
+            if (c != nil) set_parent(c, k);
+            set_left(k, l.root);
+            if (l.root != nil) set_parent(l.root, k);
+            set_left(p, k);
+        }
+        set_parent(k, p);
+        set_red(k, true);
+        update(k);
+        update_path(p);
+        if (add_leaf_fixup(k, top)) ++bh;
+        return {top, bh};
+    }
+
+    struct split_result {
+        subtree left;
+        node_ptr found; // un nodo con clave equivalente (nil si no había)
+        subtree right;
+    };
+
+    // Complejidad: O(log n) - parte t en claves < key y > key. Un nodo equivalente
+    // se devuelve en found; si hay duplicados, los demás van a garbage
+    template<typename K>
+    split_result split_rec(subtree t, const K& key, std::vector<node_ptr>& garbage) {
+        if (t.root == nil) return {{nil, 0}, nil, {nil, 0}};
+        node_ptr x = t.root;
+        subtree l = detach(left(x), t.bh - 1);
+        subtree r = detach(right(x), t.bh - 1);
+        auto c = tree_compare(comp, key, this->key(x));
+        if (c < 0) {
+            split_result s = split_rec(l, key, garbage);
+            return {s.left, s.found, join(s.right, x, r)};
+        }
+        if (c > 0) {
+            split_result s = split_rec(r, key, garbage);
+            return {join(l, x, s.left), s.found, s.right};
+        }
+        // Puede haber más claves equivalentes (duplicados) en el borde derecho de l y
+        // en el izquierdo de r; solo entonces hace falta partir esos subárboles
+        if (l.root != nil && tree_compare(comp, key, this->key(maximum(l.root))) == 0) {
+            split_result sl = split_rec(l, key, garbage);
+            if (sl.found != nil) garbage.push_back(sl.found);
+            l = sl.left;
+        }
+        if (r.root != nil && tree_compare(comp, key, this->key(minimum(r.root))) == 0) {
+            split_result sr = split_rec(r, key, garbage);
+            if (sr.found != nil) garbage.push_back(sr.found);
+            r = sr.right;
+        }
+        return {l, x, r};
+    }
+
+    // Complejidad: O(log n) - parte t en claves < key y claves >= key (duplicados incluidos)
+    std::pair<subtree, subtree> split_lower(subtree t, const T& key) {
+        if (t.root == nil) return {{nil, 0}, {nil, 0}};
+        node_ptr x = t.root;
+        subtree l = detach(left(x), t.bh - 1);
+        subtree r = detach(right(x), t.bh - 1);
+        if (less(this->key(x), key)) {
+            auto [a, b] = split_lower(r, key);
+            return {join(l, x, a), b};
+        }
+        auto [a, b] = split_lower(l, key);
+        return {a, join(b, x, r)};
+    }
+
+    // Complejidad: O(log n) - parte t en claves <= key y claves > key (duplicados incluidos)
+    std::pair<subtree, subtree> split_upper(subtree t, const T& key) {
+        if (t.root == nil) return {{nil, 0}, {nil, 0}};
+        node_ptr x = t.root;
+        subtree l = detach(left(x), t.bh - 1);
+        subtree r = detach(right(x), t.bh - 1);
+        if (!less(key, this->key(x))) {
+            auto [a, b] = split_upper(r, key);
+            return {join(l, x, a), b};
+        }
+        auto [a, b] = split_upper(l, key);
+        return {a, join(b, x, r)};
+    }
+
+    // Complejidad: O(log n) - separa el máximo de t
+    std::pair<subtree, node_ptr> split_last(subtree t) {
+        node_ptr x = t.root;
+        subtree l = detach(left(x), t.bh - 1);
+        subtree r = detach(right(x), t.bh - 1);
+        if (r.root == nil) return {l, x};
+        auto [rest, last] = split_last(r);
+        return {join(l, x, rest), last};
+    }
+
+    // Complejidad: O(log n) - une l y r (claves de l <= claves de r) sin pivote
+    subtree join2(subtree l, subtree r) {
+        if (l.root == nil) return r;
+        if (r.root == nil) return l;
+        auto [rest, last] = split_last(l);
+        return join(rest, last, r);
+    }
+
+    // Complejidad: O(n) - apunta en garbage todos los nodos del subárbol
+    void collect(node_ptr x, std::vector<node_ptr>& garbage) const {
+        if (x == nil) return;
+        garbage.push_back(x);
+        collect(left(x), garbage);
+        collect(right(x), garbage);
+    }
+
+    // Ejecuta f y g (cada una con su vector de basura) y devuelve sus subárboles.
+    // Con forks > 0, g corre en otro hilo: las dos ramas tocan subárboles disjuntos
+    // y ninguna crea ni destruye nodos (la basura se destruye al final, en serie).
+    template<typename F, typename G>
+    std::pair<subtree, subtree> fork_join(int forks, std::vector<node_ptr>& garbage, F&& f, G&& g) {
+        if (forks > 0) {
+            std::vector<node_ptr> other_garbage;
+            std::future<subtree> pending;
+            try {
+                pending = std::async(std::launch::async, [&] { return g(other_garbage); });
+            } catch (const std::system_error&) {
+                // Sin hilos disponibles: se sigue en serie
+            }
+            if (pending.valid()) {
+                subtree a = f(garbage);
+                subtree b = pending.get();
+                garbage.insert(garbage.end(), other_garbage.begin(), other_garbage.end());
+                return {a, b};
+            }
+        }
+        subtree a = f(garbage);
+        return {a, g(garbage)};
+    }
+
+    // Algoritmos de conjuntos basados en join (Blelloch, Ferizovic y Sun, "Just Join
+    // for Parallel Ordered Sets", 2016): se parte un árbol por la raíz del otro y las
+    // dos mitades se resuelven de forma independiente. Trabajo O(m log(n/m + 1)),
+    // m <= n, y profundidad O(log n log m) si las ramas corren en paralelo.
+
+    // Complejidad: ver arriba - claves de a y claves de b sin equivalente en a
+    subtree union_rec(subtree a, subtree b, std::vector<node_ptr>& garbage, int forks) {
+        if (a.root == nil) return b;
+        if (b.root == nil) return a;
+        node_ptr x = a.root;
+        subtree l = detach(left(x), a.bh - 1);
+        subtree r = detach(right(x), a.bh - 1);
+        split_result s = split_rec(b, key(x), garbage);
+        if (s.found != nil) garbage.push_back(s.found);
+        auto [ul, ur] = fork_join(forks, garbage,
+            [&](std::vector<node_ptr>& g) { return union_rec(l, s.left, g, forks - 1); },
+            [&](std::vector<node_ptr>& g) { return union_rec(r, s.right, g, forks - 1); });
+        return join(ul, x, ur);
+    }
+
+    // Complejidad: ver arriba - claves de a con equivalente en b
+    subtree intersect_rec(subtree a, subtree b, std::vector<node_ptr>& garbage, int forks) {
+        if (a.root == nil || b.root == nil) {
+            collect(a.root, garbage);
+            collect(b.root, garbage);
+            return {nil, 0};
+        }
+        node_ptr x = a.root;
+        subtree l = detach(left(x), a.bh - 1);
+        subtree r = detach(right(x), a.bh - 1);
+        split_result s = split_rec(b, key(x), garbage);
+        auto [il, ir] = fork_join(forks, garbage,
+            [&](std::vector<node_ptr>& g) { return intersect_rec(l, s.left, g, forks - 1); },
+            [&](std::vector<node_ptr>& g) { return intersect_rec(r, s.right, g, forks - 1); });
+        if (s.found != nil) {
+            garbage.push_back(s.found);
+            return join(il, x, ir);
+        }
+        garbage.push_back(x);
+        return join2(il, ir);
+    }
+
+    // Complejidad: ver arriba - claves de a sin equivalente en b
+    subtree difference_rec(subtree a, subtree b, std::vector<node_ptr>& garbage, int forks) {
+        if (a.root == nil || b.root == nil) {
+            collect(b.root, garbage);
+            return a;
+        }
+        node_ptr y = b.root;
+        subtree l = detach(left(y), b.bh - 1);
+        subtree r = detach(right(y), b.bh - 1);
+        garbage.push_back(y);
+        split_result s = split_rec(a, key(y), garbage);
+        if (s.found != nil) garbage.push_back(s.found);
+        auto [dl, dr] = fork_join(forks, garbage,
+            [&](std::vector<node_ptr>& g) { return difference_rec(s.left, l, g, forks - 1); },
+            [&](std::vector<node_ptr>& g) { return difference_rec(s.right, r, g, forks - 1); });
+        return join2(dl, dr);
+    }
+
+    // ===== Compactación =====
+
+    // Complejidad: O(log n) peor caso, O(1) amortizado en un recorrido completo -
+    // siguiente nodo en preorden
+    node_ptr preorder_next(node_ptr x) const {
+        if (left(x) != nil) return left(x);
+        if (right(x) != nil) return right(x);
+        for (node_ptr p = parent(x); p != nil; x = p, p = parent(p))
+            if (x == left(p) && right(p) != nil) return right(p);
+        return nil;
+    }
+
+    // Complejidad: O(n) - nodos de x en preorden
+    void preorder_nodes(node_ptr x, std::vector<node_ptr>& out) const {
+        if (x == nil) return;
+        out.push_back(x);
+        preorder_nodes(left(x), out);
+        preorder_nodes(right(x), out);
+    }
+
+    // Complejidad: O(n) - altura del subárbol de x (en nodos)
+    int subtree_height(node_ptr x) const {
+        if (x == nil) return 0;
+        return 1 + std::max(subtree_height(left(x)), subtree_height(right(x)));
+    }
+
+    // Complejidad: O(2^depth) - nodos a profundidad depth bajo x, de izquierda a derecha
+    void nodes_at_depth(node_ptr x, int depth, std::vector<node_ptr>& out) const {
+        if (x == nil) return;
+        if (depth == 0) {
+            out.push_back(x);
+            return;
+        }
+        nodes_at_depth(left(x), depth - 1, out);
+        nodes_at_depth(right(x), depth - 1, out);
+    }
+
+    // Complejidad: O(n log log n) - nodos de los h primeros niveles de x en orden de
+    // van Emde Boas: los h / 2 niveles de arriba y luego cada subárbol de debajo
+    void veb_nodes(node_ptr x, int h, std::vector<node_ptr>& out) const {
+        if (x == nil || h <= 0) return;
+        if (h == 1) {
+            out.push_back(x);
+            return;
+        }
+        int top = h / 2;
+        veb_nodes(x, top, out);
+        std::vector<node_ptr> bottoms;
+        nodes_at_depth(x, top, bottoms);
+        for (node_ptr b : bottoms) veb_nodes(b, h - top, out);
+    }
+
+    // Complejidad: O(1) - recrea x en un hueco nuevo del pool (la región nueva durante
+    // compact_step) y reenlaza su padre, sus hijos y los extremos cacheados
+    void relocate(node_ptr x) {
+        node_ptr nx = layout::create(pool, std::move(key(x)));
+        set_red(nx, is_red(x));
+        extra(nx) = extra(x);
+        node_ptr l = left(x), r = right(x), p = parent(x);
+        set_left(nx, l);
+        set_right(nx, r);
+        set_parent(nx, p);
+        if (l != nil) set_parent(l, nx);
+        if (r != nil) set_parent(r, nx);
+        if (p == nil)
+            root = nx;
+        else if (left(p) == x)
+            set_left(p, nx);
+        else
+            set_right(p, nx);
+        if (leftmost == x) leftmost = nx;
+        if (rightmost == x) rightmost = nx;
+        layout::destroy(pool, x);
+    }
+
+    // Complejidad: O(1) - abandona una compactación incremental a medias (antes de
+    // split, join o borrados en bloque, que mueven o destruyen nodos sin erase_node).
+    // Los nodos ya recreados se quedan donde están.
+    void cancel_compaction() {
+        if constexpr (incremental_compaction) {
+            pool.cancel_fresh_region();
+            compact_cursor = nil;
+            compact_pending = 0;
+        }
+    }
+
+    // Complejidad: O(#slabs) si el pool admite absorb, O(m) si hay que copiar las
+    // claves. Vacía other y devuelve la raíz de sus nodos, ya en el pool de este árbol.
+    node_ptr adopt(RB_tree& other) {
+        cancel_compaction();
+        other.cancel_compaction();
+        node_ptr r = nil;
+        if constexpr (requires { pool.absorb(std::move(other.pool)); }) {
+            pool.absorb(std::move(other.pool));
+            r = other.root;
+        } else {
+            std::vector<T> keys(other.begin(), other.end());
+            std::size_t n = keys.size();
+            if (n > 0)
+                r = build_balanced(keys.begin(), 0, n, 0, std::bit_width(n + 1) - 1, nil);
+            other.clear();
+        }
+        other.root = other.leftmost = other.rightmost = nil;
+        other.node_count = 0;
+        return r;
+    }
+
+    // Complejidad: O(log n) - instala r como raíz con n nodos
+    void reset_root(node_ptr r, std::size_t n) {
+        root = r;
+        if (r != nil) {
+            set_parent(r, nil);
+            set_red(r, false);
+        }
+        leftmost = r != nil ? minimum(r) : nil;
+        rightmost = r != nil ? maximum(r) : nil;
+        node_count = n;
+    }
+
+    // Niveles de la recursión que se reparten entre hilos: 2^forks tareas. Con
+    // instrumentación, ninguno: las dos ramas incrementarían los mismos contadores
+    static int parallel_forks(bool parallel) {
+        if (!parallel || Stats::enabled) return 0;
+        unsigned cores = std::thread::hardware_concurrency();
+        return std::bit_width(cores == 0 ? 1u : cores);
+    }
+
+    // Complejidad: la de op más O(#slabs de other) o O(m) de adopt
+    template<typename Op>
+    void set_operation(RB_tree& other, bool parallel, Op op) {
+        std::size_t total = node_count + other.node_count;
+        node_ptr b = adopt(other);
+        std::vector<node_ptr> garbage;
+        subtree result = (this->*op)({root, black_height(root)}, {b, black_height(b)}, garbage, parallel_forks(parallel));
+        for (node_ptr g : garbage) layout::destroy(pool, g);
+        reset_root(result.root, total - garbage.size());
     }
 
     // Complejidad: O(n) - visita cada nodo exactamente una vez
-    void print_inorder(Node<T>* node) {
-        if (node == nullptr) return;
-        print_inorder(node->left);
-        std::cout << node->key << (node->color ? "(R)" : "(B)") << " ";
-        print_inorder(node->right);
+    void print_inorder(node_ptr node) {
+        if (node == nil) return;
+        print_inorder(left(node));
+        std::cout << key(node) << (is_red(node) ? "(R)" : "(B)") << " ";
+        print_inorder(right(node));
     }
 
     // Complejidad: O(n) - visita cada nodo exactamente una vez
-    void print_preorder(Node<T>* node, std::string prefix = "", bool is_left = false, bool is_root = true) {
-        if (node == nullptr) return;
+    void print_preorder(node_ptr node, std::string prefix = "", bool is_left = false, bool is_root = true) {
+        if (node == nil) return;
 
         std::cout << prefix;
 
@@ -232,153 +1377,801 @@ private:
             std::cout << (is_left ? "├──L: " : "└──R: ");
         }
 
-        std::cout << node->key << (node->color ? "(R)" : "(B)") << std::endl;
+        std::cout << key(node) << (is_red(node) ? "(R)" : "(B)") << std::endl;
 
-        if (node->left != nullptr || node->right != nullptr) {
+        if (left(node) != nil || right(node) != nil) {
             std::string new_prefix = prefix;
             if (!is_root) {
                 new_prefix += (is_left ? "│   " : "    ");
             }
 
-            if (node->left != nullptr) {
-                print_preorder(node->left, new_prefix, true, false);
+            if (left(node) != nil) {
+                print_preorder(left(node), new_prefix, true, false);
             }
-            if (node->right != nullptr) {
-                print_preorder(node->right, new_prefix, false, false);
+            if (right(node) != nil) {
+                print_preorder(right(node), new_prefix, false, false);
             }
         }
     }
+    template<typename, typename, template<typename> class, typename, typename, typename>
+    friend class ConcurrentRBTree;
+    template<typename, typename, typename>
+    friend class MappedRBTree;
+
 public:
+    // Iterador bidireccional sobre las claves en orden. Las claves no se pueden
+    // modificar a través del iterador (cambiarían su posición en el árbol).
+    // ++ y -- siguen los punteros al padre: recorrer k claves cuesta O(k + log n).
+    class const_iterator {
+    private:
+        friend class RB_tree;
+        const RB_tree* tree = nullptr;
+        node_ptr node = nil;
+
+        const_iterator(const RB_tree* t, node_ptr n) : tree(t), node(n) {}
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() = default;
+
+        reference operator*() const { return tree->key(node); }
+        pointer operator->() const { return &tree->key(node); }
+
+        const_iterator& operator++() {
+            node = tree->next_node(node);
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+        // --end() lleva al máximo cacheado
+        const_iterator& operator--() {
+            node = node == nil ? tree->rightmost : tree->prev_node(node);
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator old = *this;
+            --*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator& other) const { return node == other.node; }
+    };
+    using iterator = const_iterator;
+
+    // Complejidad: O(1) - usan el mínimo cacheado y el centinela nil
+    const_iterator begin() const { return const_iterator(this, leftmost); }
+    const_iterator end() const { return const_iterator(this, nil); }
+
+    // Complejidad: O(log n)
+    const_iterator lower_bound(const T& key) const { return const_iterator(this, lower_bound_node(key)); }
+    const_iterator upper_bound(const T& key) const { return const_iterator(this, upper_bound_node(key)); }
+    std::pair<const_iterator, const_iterator> equal_range(const T& key) const {
+        return {lower_bound(key), upper_bound(key)};
+    }
+    // Búsqueda heterogénea: solo con un comparador transparente (std::less<>, etc.)
+    template<typename K> requires transparent_compare<Compare>
+    const_iterator lower_bound(const K& key) const { return const_iterator(this, lower_bound_node(key)); }
+    template<typename K> requires transparent_compare<Compare>
+    const_iterator upper_bound(const K& key) const { return const_iterator(this, upper_bound_node(key)); }
+    template<typename K> requires transparent_compare<Compare>
+    std::pair<const_iterator, const_iterator> equal_range(const K& key) const {
+        return {lower_bound(key), upper_bound(key)};
+    }
+
+    // Tamaño en bytes de un nodo con el layout elegido
+    static constexpr std::size_t node_bytes = sizeof(typename layout::node);
+
     // Complejidad: O(1) - inicialización simple
     RB_tree() {
-        root = nullptr;
+        root = nil;
+    }
+
+    // Complejidad: O(1) - árbol vacío con un comparador con estado
+    explicit RB_tree(const Compare& c) : comp(c) {
+        root = nil;
     }
 
     // Complejidad: O(1) - creación de un solo nodo
-    RB_tree(T key) {
-        root = new Node<T>(key);
-        root->color = false; // Raíz siempre negra
+    RB_tree(const T& key) {
+        root = layout::create(pool, key);
+        set_red(root, false); // Raíz siempre negra
+        update(root);
+        leftmost = rightmost = root;
+        node_count = 1;
+    }
+
+    // Complejidad: O(n) si [first, last) ya está ordenado, O(n log n) si hay que ordenarlo
+    template<typename It>
+    RB_tree(It first, It last, bool parallel_sort = false, const Compare& c = Compare()) : comp(c) {
+        root = nil;
+        assign(first, last, parallel_sort);
     }
 
-    // Complejidad: O(n) - el destructor de Node elimina recursivamente todos los nodos
+    RB_tree(const RB_tree&) = delete;
+    RB_tree& operator=(const RB_tree&) = delete;
+
+    // Complejidad: O(1) - el pool cambia de dueño con sus nodos; other queda vacío
+    RB_tree(RB_tree&& other) noexcept
+        : root(other.root), leftmost(other.leftmost), rightmost(other.rightmost),
+          node_count(other.node_count), pool(std::move(other.pool)), comp(std::move(other.comp)),
+          compact_cursor(other.compact_cursor), compact_pending(other.compact_pending) {
+        other.root = other.leftmost = other.rightmost = other.compact_cursor = nil;
+        other.node_count = other.compact_pending = 0;
+    }
+    // Complejidad: la de clear() más O(1)
+    RB_tree& operator=(RB_tree&& other) noexcept {
+        if (this != &other) {
+            clear();
+            root = other.root;
+            leftmost = other.leftmost;
+            rightmost = other.rightmost;
+            node_count = other.node_count;
+            pool = std::move(other.pool);
+            comp = std::move(other.comp);
+            compact_cursor = other.compact_cursor;
+            compact_pending = other.compact_pending;
+            other.root = other.leftmost = other.rightmost = other.compact_cursor = nil;
+            other.node_count = other.compact_pending = 0;
+        }
+        return *this;
+    }
+
+    // Complejidad: O(#slabs) con slab_pool y claves trivialmente destructibles,
+    // O(n) en otro caso (hay que destruir cada nodo)
     ~RB_tree() {
-        if (root) delete root;
+        clear();
     }
 
-    // Complejidad: O(log n) - búsqueda O(log n) + fixup O(log n) = O(log n)
-    // Garantiza balanceo del árbol después de la inserción
-    void add_leaf(T key) {
-        Node<T>* new_node = new Node<T>(key);
-        Node<T>* parent = nullptr;
-        Node<T>* current = root;
-        // Búsqueda de posición: O(log n)
-        while (current != nullptr) {
-            parent = current;
-            if (new_node->key < current->key)
-                current = current->left;
+    // Complejidad: igual que el destructor
+    void clear() {
+        if constexpr (!(layout::pool_type::bulk_release && std::is_trivially_destructible_v<typename layout::node>))
+            destroy_subtree(root);
+        pool.release();
+        root = leftmost = rightmost = nil;
+        compact_cursor = nil;
+        compact_pending = 0;
+        node_count = 0;
+    }
+
+    // Complejidad: O(n) - vacía el árbol pero deja los nodos en el pool para
+    // reutilizarlos (la memoria no se libera hasta clear() o el destructor)
+    void clear_keep_memory() {
+        cancel_compaction();
+        destroy_subtree(root);
+        root = leftmost = rightmost = nil;
+        node_count = 0;
+    }
+
+    // Carga masiva: sustituye el contenido por las claves de [first, last).
+    // Entrada ordenada: construcción directa en O(n), sin descensos ni fixups.
+    // Entrada desordenada: se copia y se ordena primero (en paralelo con
+    // parallel_sort si se compiló con RB_TREE_PARALLEL_SORT).
+    template<typename It>
+    void assign(It first, It last, bool parallel_sort = false) {
+        if constexpr (std::random_access_iterator<It>) {
+            if (std::is_sorted(first, last, comp)) {
+                build_from_sorted(first, last);
+                return;
+            }
+        }
+        std::vector<T> keys(first, last);
+        if (!std::is_sorted(keys.begin(), keys.end(), comp)) {
+#ifdef RB_TREE_PARALLEL_SORT
+            if (parallel_sort)
+                std::sort(std::execution::par, keys.begin(), keys.end(), comp);
             else
-                current = current->right;
+                std::sort(keys.begin(), keys.end(), comp);
+#else
+            (void)parallel_sort;
+            std::sort(keys.begin(), keys.end(), comp);
+#endif
         }
-        new_node->parent = parent;
-        if (parent == nullptr) {
-            root = new_node;
-        } else if (new_node->key < parent->key) {
-            parent->left = new_node;
-        } else {
-            parent->right = new_node;
+        build_from_sorted(keys.begin(), keys.end());
+    }
+
+    // Contadores de la política Stats (vacíos con tree_no_stats, ver TreeStats.h)
+    const Stats& stats() const {
+        return counters;
+    }
+    void reset_stats() {
+        counters.reset();
+    }
+
+    // Memoria reservada por el pool (0 si el pool no lleva la cuenta)
+    std::size_t reserved_bytes() const {
+        if constexpr (requires { pool.reserved_bytes(); })
+            return pool.reserved_bytes();
+        else
+            return 0;
+    }
+
+    // Complejidad: O(n) - snapshot binario en path (formato en TreeSnapshot.h): cabecera
+    // y claves en orden; con with_shape, también la forma y el color de cada nodo
+    // (medio byte por nodo) para que load reconstruya exactamente este árbol
+    void save(const std::string& path, bool with_shape = false) const requires std::is_trivially_copyable_v<T> {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) throw std::runtime_error("RB_tree::save: no se puede crear " + path);
+        tree_snapshot_header h{};
+        std::memcpy(h.magic, tree_snapshot_magic, sizeof h.magic);
+        h.byte_order = tree_snapshot_byte_order;
+        h.key_bytes = sizeof(T);
+        h.count = node_count;
+        h.flags = with_shape ? tree_snapshot_shape : 0u;
+        out.write(reinterpret_cast<const char*>(&h), sizeof h);
+
+        // Las claves salen por bloques, sin copiar el árbol entero a un vector
+        const std::size_t block = 1 << 16;
+        std::vector<T> keys;
+        keys.reserve(std::min(node_count, block));
+        for (const T& k : *this) {
+            keys.push_back(k);
+            if (keys.size() == block) {
+                out.write(reinterpret_cast<const char*>(keys.data()), static_cast<std::streamsize>(keys.size() * sizeof(T)));
+                keys.clear();
+            }
         }
-        // Rebalanceo: O(log n)
-        add_leaf_fixup(new_node);
+        out.write(reinterpret_cast<const char*>(keys.data()), static_cast<std::streamsize>(keys.size() * sizeof(T)));
+
+        if (with_shape) {
+            std::vector<std::uint8_t> shape((node_count + 1) / 2, 0);
+            std::size_t i = 0;
+            collect_shape(root, shape, i);
+            out.write(reinterpret_cast<const char*>(shape.data()), static_cast<std::streamsize>(shape.size()));
+        }
+        if (!out.flush()) throw std::runtime_error("RB_tree::save: error al escribir " + path);
+    }
+
+    // Complejidad: O(n) - sustituye el contenido por el snapshot de path sin un solo
+    // descenso ni fixup. El archivo se proyecta en memoria (mapped_file) y los nodos
+    // se crean leyendo las claves directamente de la proyección: con la forma guardada
+    // se rehace el árbol tal cual era; sin ella, build_from_sorted. Si el archivo no
+    // es válido lanza std::runtime_error y el árbol no cambia.
+    void load(const std::string& path) requires std::is_trivially_copyable_v<T> {
+        static_assert(alignof(T) <= sizeof(tree_snapshot_header), "las claves empiezan en el byte 32 del archivo");
+        mapped_file file(path);
+        tree_snapshot_header h;
+        if (file.size() < sizeof h) throw std::runtime_error("RB_tree::load: " + path + " no es un snapshot");
+        std::memcpy(&h, file.data(), sizeof h);
+        if (std::memcmp(h.magic, tree_snapshot_magic, sizeof h.magic) != 0 ||
+            h.byte_order != tree_snapshot_byte_order || h.key_bytes != sizeof(T))
+            throw std::runtime_error("RB_tree::load: " + path + " no es un snapshot de este tipo de clave");
+
+        const bool shaped = (h.flags & tree_snapshot_shape) != 0;
+        const std::size_t available = file.size() - sizeof h;
+        if (h.count > available / sizeof(T) ||
+            (shaped && (h.count + 1) / 2 > available - h.count * sizeof(T)))
+            throw std::runtime_error("RB_tree::load: " + path + " está truncado");
+        const std::size_t n = static_cast<std::size_t>(h.count);
+        const T* keys = reinterpret_cast<const T*>(file.data() + sizeof h);
+        if (!std::is_sorted(keys, keys + n, comp))
+            throw std::runtime_error("RB_tree::load: las claves de " + path + " no están ordenadas");
+
+        if (!shaped) {
+            build_from_sorted(keys, keys + n);
+            return;
+        }
+        const std::uint8_t* shape = reinterpret_cast<const std::uint8_t*>(keys + n);
+        std::size_t i = 0;
+        if (n != 0 && ((shape_bits(shape, 0) & 4u) != 0 || shape_black_height(shape, n, i, false, 0) < 0 || i != n))
+            throw std::runtime_error("RB_tree::load: la forma guardada en " + path + " no es un árbol rojo-negro");
+        clear();
+        if (n == 0) return;
+        i = 0;
+        std::size_t k = 0;
+        root = build_shaped(shape, keys, i, k, nil);
+        leftmost = minimum(root);
+        rightmost = maximum(root);
+        node_count = n;
+    }
+
+    // Complejidad: O(log n) - búsqueda O(log n) + fixup O(log n) = O(log n)
+    // Garantiza balanceo del árbol después de la inserción. Admite duplicados.
+    void add_leaf(const T& key) {
+        insert_equal_node(layout::create(pool, key));
+    }
+    void add_leaf(T&& key) {
+        insert_equal_node(layout::create(pool, std::move(key)));
+    }
+
+    // Complejidad: O(1) amortizado + fixup si key va justo antes de hint (o detrás del
+    // máximo con hint == end()), O(log n) si la pista no sirve. Admite duplicados como
+    // add_leaf y devuelve la posición de la clave insertada.
+    const_iterator insert_hint(const_iterator hint, const T& key) {
+        node_ptr z = layout::create(pool, key);
+        insert_hint_node(hint.node, z);
+        return const_iterator(this, z);
+    }
+    const_iterator insert_hint(const_iterator hint, T&& key) {
+        node_ptr z = layout::create(pool, std::move(key));
+        insert_hint_node(hint.node, z);
+        return const_iterator(this, z);
+    }
+
+    // Complejidad: O(log n) - inserción sin duplicados en un solo descenso.
+    // Si la clave ya estaba no se reserva ni se copia nada y devuelve {posición, false}.
+    std::pair<const_iterator, bool> insert_unique(const T& key) {
+        bool as_left;
+        auto [found, parent] = find_unique_slot(key, as_left);
+        if (found != nil)
+            return {const_iterator(this, found), false};
+        node_ptr z = layout::create(pool, key);
+        link_node(z, parent, as_left);
+        return {const_iterator(this, z), true};
+    }
+    std::pair<const_iterator, bool> insert_unique(T&& key) {
+        bool as_left;
+        auto [found, parent] = find_unique_slot(key, as_left);
+        if (found != nil)
+            return {const_iterator(this, found), false};
+        node_ptr z = layout::create(pool, std::move(key));
+        link_node(z, parent, as_left);
+        return {const_iterator(this, z), true};
+    }
+
+    // Complejidad: O(log n) - construye la clave en el nodo a partir de args y la
+    // inserta sin duplicados; si ya estaba, el nodo se devuelve al pool
+    template<typename... Args>
+    std::pair<const_iterator, bool> emplace(Args&&... args) {
+        node_ptr z = layout::create(pool, std::forward<Args>(args)...);
+        bool as_left;
+        auto [found, parent] = find_unique_slot(this->key(z), as_left);
+        if (found != nil) {
+            layout::destroy(pool, z);
+            return {const_iterator(this, found), false};
+        }
+        link_node(z, parent, as_left);
+        return {const_iterator(this, z), true};
     }
 
     // Complejidad: O(log n) - búsqueda O(log n) + eliminación y fixup O(log n) = O(log n)
     // Incluye encontrar el nodo, transplantarlo y rebalancear el árbol
-    bool delete_leaf(T key) {
-        Node<T>* z = find_node(key); // O(log n)
-        if (z == nullptr) return false;
-        Node<T>* y = z;
-        Node<T>* x;
-        Node<T>* x_parent;
-        bool y_original_color = y->color;
-        if (z->left == nullptr) {
-            x = z->right;
-            x_parent = z->parent;
-            transplant(z, z->right);
-        } else if (z->right == nullptr) {
-            x = z->left;
-            x_parent = z->parent;
-            transplant(z, z->left);
+    bool delete_leaf(const T& key) {
+        node_ptr z = find_node(key); // O(log n)
+        if (z == nil) return false;
+        erase_node(z);
+        return true;
+    }
+    template<typename K> requires transparent_compare<Compare>
+    bool delete_leaf(const K& key) {
+        node_ptr z = find_node(key);
+        if (z == nil) return false;
+        erase_node(z);
+        return true;
+    }
+
+    // Complejidad: O(1) amortizado (el sucesor y el rebalanceo) sin descenso: borra el
+    // nodo de pos y devuelve un iterador al siguiente. Los demás iteradores siguen
+    // siendo válidos (los nodos no se mueven, solo se reenlazan).
+    const_iterator erase(const_iterator pos) {
+        node_ptr next = next_node(pos.node);
+        erase_node(pos.node);
+        return const_iterator(this, next);
+    }
+
+    // Complejidad: O(log n + k) - borra las k claves del intervalo cerrado [lo, hi]
+    // (duplicados incluidos) y devuelve k. En lugar de k borrados con su descenso y su
+    // fixup, parte el árbol en < lo, [lo, hi] y > hi, devuelve al pool los nodos de en
+    // medio y une las otras dos partes.
+    std::size_t erase_range(const T& lo, const T& hi) {
+        if (root == nil || less(hi, lo)) return 0;
+        cancel_compaction();
+        auto [below, rest] = split_lower({root, black_height(root)}, lo);
+        auto [doomed, above] = split_upper(rest, hi);
+        std::size_t k = destroy_counted(doomed.root);
+        subtree joined = join2(below, above);
+        reset_root(joined.root, node_count - k);
+        return k;
+    }
+
+    // Complejidad: O(log n) - búsqueda binaria en árbol balanceado
+    bool find(const T& key) const {
+        return find_node(key) != nil;
+    }
+    template<typename K> requires transparent_compare<Compare>
+    bool find(const K& key) const {
+        return find_node(key) != nil;
+    }
+
+    // Complejidad: O(m log n) para m claves, igual que m llamadas a find, pero los
+    // descensos avanzan en grupos de tree_find_group al mismo paso y se hace prefetch
+    // del siguiente hijo de cada uno: los fallos de caché de claves distintas se
+    // solapan en lugar de esperar uno tras otro. out[i] = find(keys[i]).
+    void find_many(std::span<const T> keys, std::span<bool> out) const {
+        if (out.size() < keys.size())
+            throw std::invalid_argument("find_many: out es más corto que keys");
+        node_ptr current[tree_find_group];
+        for (std::size_t base = 0; base < keys.size(); base += tree_find_group) {
+            std::size_t group = std::min(tree_find_group, keys.size() - base);
+            for (std::size_t i = 0; i < group; ++i) {
+                current[i] = root;
+                out[base + i] = false;
+            }
+            std::size_t active = root != nil ? group : 0;
+            while (active > 0) {
+                active = 0;
+                for (std::size_t i = 0; i < group; ++i) {
+                    node_ptr x = current[i];
+                    if (x == nil) continue;
+                    auto c = tree_compare(comp, keys[base + i], key(x));
+                    if (c == 0) {
+                        out[base + i] = true;
+                        current[i] = nil;
+                        continue;
+                    }
+                    x = c < 0 ? left(x) : right(x);
+                    current[i] = x;
+                    if (x != nil) {
+                        tree_prefetch(layout::address(pool, x));
+                        ++active;
+                    }
+                }
+            }
+        }
+    }
+
+    // Complejidad: O(n) - copia las claves en orden a un índice inmutable y contiguo
+    // (ver FrozenIndex.h): FrozenIndex por defecto, o FrozenBlockIndex<T> con claves
+    // enteras. El índice no ve los cambios posteriores del árbol.
+    template<typename Index = FrozenIndex<T, Compare>>
+    Index freeze() const {
+        return Index(begin(), node_count, comp);
+    }
+
+    // ===== Compactación =====
+    // Tras mucho add_leaf/delete_leaf los nodos quedan repartidos por los huecos del
+    // pool en el orden en que se liberaron y cada descenso salta de una línea de caché
+    // (y de una página) a otra. Compactar recrea los nodos vivos en memoria contigua,
+    // en un orden que sigue los descensos. El árbol sigue siendo modificable después;
+    // los iteradores anteriores dejan de ser válidos.
+
+    // Complejidad: O(n) (O(n log log n) con van_emde_boas) y O(n) de memoria auxiliar.
+    // Copia los nodos a un pool nuevo en el orden pedido, reescribe los enlaces y
+    // libera el pool viejo de una vez. Bloquea durante toda la copia: para repartir el
+    // trabajo en pasos acotados, compact_step.
+    void compact(rb_node_order order = rb_node_order::preorder)
+        requires std::is_default_constructible_v<typename layout::pool_type> {
+        cancel_compaction();
+        if (root == nil) return;
+        std::vector<node_ptr> nodes;
+        nodes.reserve(node_count);
+        if (order == rb_node_order::van_emde_boas)
+            veb_nodes(root, subtree_height(root), nodes);
+        else
+            preorder_nodes(root, nodes);
+
+        typename layout::pool_type fresh;
+        // El campo padre del nodo viejo pasa a guardar su copia: los enlaces se
+        // traducen en una segunda pasada sin ninguna tabla aparte
+        for (node_ptr x : nodes) {
+            node_ptr nx = layout::create(fresh, std::move(key(x)));
+            layout::set_red(fresh, nx, is_red(x));
+            layout::extra(fresh, nx) = extra(x);
+            set_parent(x, nx);
+        }
+        for (node_ptr x : nodes) {
+            node_ptr nx = parent(x), l = left(x), r = right(x);
+            layout::set_left(fresh, nx, l != nil ? parent(l) : nil);
+            layout::set_right(fresh, nx, r != nil ? parent(r) : nil);
+            if (l != nil) layout::set_parent(fresh, parent(l), nx);
+            if (r != nil) layout::set_parent(fresh, parent(r), nx);
+        }
+        node_ptr new_root = parent(root);
+        node_ptr new_leftmost = parent(leftmost), new_rightmost = parent(rightmost);
+        layout::set_parent(fresh, new_root, nil);
+        // Las claves viejas ya están movidas; solo queda destruirlas si no son triviales
+        if constexpr (!(layout::pool_type::bulk_release && std::is_trivially_destructible_v<typename layout::node>))
+            for (node_ptr x : nodes) layout::destroy(pool, x);
+        pool = std::move(fresh);
+        root = new_root;
+        leftmost = new_leftmost;
+        rightmost = new_rightmost;
+    }
+
+    // Complejidad: O(max_nodes log #slabs) por llamada - compactación incremental.
+    // La primera llamada abre una región nueva en el pool; cada llamada visita los
+    // siguientes max_nodes nodos en preorden y recrea en la región los que siguen en
+    // slabs viejos (el cursor es un nodo: sobrevive a inserciones, borrados y
+    // rotaciones entre llamadas). Si una rotación deja nodos viejos por detrás del
+    // cursor, el recorrido vuelve a empezar por la raíz. Cuando no queda ninguno se
+    // liberan los slabs viejos. Mientras dura, los nodos nuevos también salen de la
+    // región nueva; split, join, erase_range y las operaciones de conjuntos la
+    // abandonan (compact_step empieza otra). Devuelve true cuando ha terminado.
+    bool compact_step(std::size_t max_nodes) requires incremental_compaction {
+        if (!pool.in_fresh_region()) {
+            if (root == nil) return true;
+            pool.begin_fresh_region();
+            compact_cursor = root;
+            compact_pending = node_count;
+        }
+        for (std::size_t k = 0; k < max_nodes && compact_pending > 0; ++k) {
+            if (compact_cursor == nil) compact_cursor = root;
+            node_ptr x = compact_cursor;
+            compact_cursor = preorder_next(x);
+            if (pool.in_old_region(layout::address(pool, x))) {
+                relocate(x);
+                --compact_pending;
+            }
+        }
+        if (compact_pending > 0) return false;
+        pool.end_fresh_region();
+        compact_cursor = nil;
+        return true;
+    }
+
+    // true si hay una compactación incremental a medias
+    bool compacting() const {
+        if constexpr (incremental_compaction)
+            return pool.in_fresh_region();
+        else
+            return false;
+    }
+
+    // ===== join, split y operaciones de conjuntos =====
+    // Los nodos de other pasan a este árbol sin copiarse (con slab_pool se absorben
+    // sus slabs, con heap_pool no hay nada que mover); con index_pool se copian las
+    // claves en O(m). other queda vacío. Se supone el mismo criterio de orden en ambos.
+    //
+    // Complejidad: O(log n + log m) - *this pasa a ser *this, pivot y right, en ese
+    // orden. Exige max(*this) <= pivot <= min(right); si no, lanza invalid_argument.
+    // Si no se puede crear el nodo del pivote, right ya está concatenado sin él.
+    void join(const T& pivot, RB_tree&& right) {
+        if (&right == this)
+            throw std::invalid_argument("join: un árbol no se puede unir consigo mismo");
+        if ((rightmost != nil && less(pivot, key(rightmost))) ||
+            (right.leftmost != nil && less(right.key(right.leftmost), pivot)))
+            throw std::invalid_argument("join: las claves no están ordenadas respecto al pivote");
+        std::size_t total = node_count + right.node_count + 1;
+        node_ptr r = adopt(right);
+        node_ptr k;
+        try {
+            k = layout::create(pool, pivot);
+        } catch (...) {
+            subtree joined = join2({root, black_height(root)}, {r, black_height(r)});
+            reset_root(joined.root, total - 1);
+            throw;
+        }
+        subtree joined = join({root, black_height(root)}, k, {r, black_height(r)});
+        reset_root(joined.root, total);
+    }
+
+    // Complejidad: O(log n + log m) - concatena right detrás de *this (sin pivote).
+    // Exige max(*this) <= min(right); si no, lanza invalid_argument.
+    void join(RB_tree&& right) {
+        if (&right == this)
+            throw std::invalid_argument("join: un árbol no se puede unir consigo mismo");
+        if (rightmost != nil && right.leftmost != nil && less(right.key(right.leftmost), key(rightmost)))
+            throw std::invalid_argument("join: las claves no están ordenadas");
+        std::size_t total = node_count + right.node_count;
+        node_ptr r = adopt(right);
+        subtree joined = join2({root, black_height(root)}, {r, black_height(r)});
+        reset_root(joined.root, total);
+    }
+
+    // Complejidad: O(log n) si los nodos pueden cambiar de pool (heap_pool) y el árbol
+    // conoce los tamaños de subárbol (rb_order_statistics); si no, O(log n + m) con m
+    // el tamaño de la parte devuelta (hay que contarla o copiarla a su propio pool).
+    // *this se queda con las claves < key y devuelve un árbol con las claves >= key.
+    RB_tree split(const T& key) {
+        cancel_compaction();
+        std::size_t n = node_count;
+        auto [l, r] = split_lower({root, black_height(root)}, key);
+        RB_tree right(comp);
+        std::size_t m;
+        if constexpr (layout::pool_type::transferable_nodes) {
+            if constexpr (Augment::enabled && requires(augment_data d) { d.size; }) {
+                m = subtree_size(r.root);
+            } else {
+                std::vector<node_ptr> nodes;
+                collect(r.root, nodes);
+                m = nodes.size();
+            }
+            right.reset_root(r.root, m);
         } else {
-            y = minimum(z->right); // O(log n)
-            y_original_color = y->color;
-            x = y->right;
-            if (y->parent == z) {
-                x_parent = y;
+            std::vector<T> keys;
+            if (r.root != nil)
+                for (node_ptr x = minimum(r.root); x != nil; x = next_node(x))
+                    keys.push_back(this->key(x));
+            std::vector<node_ptr> nodes;
+            collect(r.root, nodes);
+            m = nodes.size();
+            for (node_ptr x : nodes) layout::destroy(pool, x);
+            right.build_from_sorted(keys.begin(), keys.end());
+        }
+        reset_root(l.root, n - m);
+        return right;
+    }
+
+    // Complejidad: O(m log(n/m + 1)) con m <= n el tamaño del menor, más adopt.
+    // *this pasa a contener sus claves y las de other que no tenía. Con parallel las
+    // dos mitades de cada nivel se resuelven en hilos distintos (fork-join).
+    void union_with(RB_tree&& other, bool parallel = false) {
+        if (&other == this) return;
+        set_operation(other, parallel, &RB_tree::union_rec);
+    }
+
+    // Complejidad: igual que union_with - *this se queda con sus claves que también
+    // están en other (una por cada clave distinta)
+    void intersect_with(RB_tree&& other, bool parallel = false) {
+        if (&other == this) return;
+        set_operation(other, parallel, &RB_tree::intersect_rec);
+    }
+
+    // Complejidad: igual que union_with - *this pierde las claves que están en other
+    void difference_with(RB_tree&& other, bool parallel = false) {
+        if (&other == this) {
+            clear();
+            return;
+        }
+        set_operation(other, parallel, &RB_tree::difference_rec);
+    }
+
+    // Complejidad: O(1)
+    std::size_t size() const {
+        return node_count;
+    }
+    bool empty() const {
+        return node_count == 0;
+    }
+
+    // ===== Estadísticos de orden (Augment = rb_order_statistics) =====
+
+    // Complejidad: O(log n) - número de claves estrictamente menores que key
+    std::size_t rank(const T& key) const requires requires(augment_data d) { d.size; } {
+        std::size_t r = 0;
+        node_ptr current = root;
+        while (current != nil) {
+            if (less(this->key(current), key)) {
+                r += subtree_size(left(current)) + 1;
+                current = right(current);
             } else {
-                x_parent = y->parent;
-                transplant(y, y->right);
-                y->right = z->right;
-                y->right->parent = y;
+                current = left(current);
             }
-            transplant(z, y);
-            y->left = z->left;
-            y->left->parent = y;
-            y->color = z->color;
         }
-        z->left = nullptr;
-        z->right = nullptr;
-        delete z;
-        if (y_original_color == false)
-            delete_leaf_fixup(x, x_parent); // O(log n)
-        return true;
+        return r;
     }
 
-    // Complejidad: O(log n) - búsqueda binaria en árbol balanceado
-    bool find(T key) {
-        return find_node(key) != nullptr;
+    // Complejidad: O(log n) - número de claves menores o iguales que key
+    std::size_t rank_upper(const T& key) const requires requires(augment_data d) { d.size; } {
+        std::size_t r = 0;
+        node_ptr current = root;
+        while (current != nil) {
+            if (less(key, this->key(current))) {
+                current = left(current);
+            } else {
+                r += subtree_size(left(current)) + 1;
+                current = right(current);
+            }
+        }
+        return r;
+    }
+
+    // Complejidad: O(log n) - k-ésima clave más pequeña (k empieza en 0)
+    const T& select(std::size_t k) const requires requires(augment_data d) { d.size; } {
+        if (k >= node_count)
+            throw std::out_of_range("select: k fuera de rango");
+        node_ptr current = root;
+        while (true) {
+            std::size_t left_size = subtree_size(left(current));
+            if (k < left_size) {
+                current = left(current);
+            } else if (k == left_size) {
+                return this->key(current);
+            } else {
+                k -= left_size + 1;
+                current = right(current);
+            }
+        }
+    }
+
+    // Complejidad: O(log n) - número de claves en el intervalo cerrado [lo, hi]
+    std::size_t count_range(const T& lo, const T& hi) const requires requires(augment_data d) { d.size; } {
+        if (less(hi, lo)) return 0;
+        return rank_upper(hi) - rank(lo);
+    }
+
+    // ===== Intervalos (Augment = rb_interval_max) =====
+
+    // Complejidad: O(log n + k) - llama a callback(intervalo) para cada uno de los k intervalos
+    // guardados que cortan el intervalo cerrado [a, b], en orden, y devuelve k
+    template<typename E, typename F>
+    std::size_t overlapping(const E& a, const E& b, F callback) const requires requires(augment_data d) { d.max_end; } {
+        if (b < a) return 0;
+        return overlapping_in(root, a, b, callback);
+    }
+
+    // ===== Agregados (Augment = rb_monoid_aggregate) =====
+
+    // Complejidad: O(1) - agregado de todo el árbol
+    auto aggregate() const requires requires { typename Augment::monoid; } {
+        using M = typename Augment::monoid;
+        if constexpr (Augment::enabled) {
+            return root == nil ? M::identity() : extra(root).value;
+        } else {
+            return M::identity();
+        }
+    }
+
+    // Complejidad: O(log n) - combinación, en orden, de los elementos con clave en el
+    // intervalo cerrado [lo, hi]. Se baja hasta el primer nodo dentro del intervalo
+    // (donde se separan los caminos hacia lo y hacia hi) y desde él se recorren los dos
+    // bordes: cada subárbol que queda entero dentro aporta su agregado guardado.
+    template<typename K>
+    auto aggregate(const K& lo, const K& hi) const requires requires { typename Augment::monoid; } {
+        using M = typename Augment::monoid;
+        if constexpr (!Augment::enabled) {
+            return M::identity();
+        } else {
+            auto value_of = [&](node_ptr x) { return x == nil ? M::identity() : extra(x).value; };
+            node_ptr x = root;
+            if (less(hi, lo)) x = nil;
+            while (x != nil) {
+                if (less(this->key(x), lo)) x = right(x);
+                else if (less(hi, this->key(x))) x = left(x);
+                else break;
+            }
+            if (x == nil) return M::identity();
+            // Borde izquierdo: claves >= lo del subárbol izquierdo de x
+            auto below = M::identity();
+            for (node_ptr y = left(x); y != nil;) {
+                if (less(this->key(y), lo)) {
+                    y = right(y);
+                } else {
+                    below = M::combine(M::combine(M::of(this->key(y).second), value_of(right(y))), below);
+                    y = left(y);
+                }
+            }
+            // Borde derecho: claves <= hi del subárbol derecho de x
+            auto above = M::identity();
+            for (node_ptr z = right(x); z != nil;) {
+                if (less(hi, this->key(z))) {
+                    z = left(z);
+                } else {
+                    above = M::combine(above, M::combine(value_of(left(z)), M::of(this->key(z).second)));
+                    z = right(z);
+                }
+            }
+            return M::combine(M::combine(below, M::of(this->key(x).second)), above);
+        }
     }
 
     // Complejidad: O(log n) - búsqueda del nodo O(log n) + encontrar mínimo O(log n) = O(log n)
     // o recorrido hacia arriba O(log n)
-    T sucesor(T key) {
-        Node<T>* node = find_node(key);
-        if (node == nullptr) {
+    // Para recorrer rangos es preferible lower_bound/upper_bound y los iteradores
+    T sucesor(const T& key) {
+        node_ptr node = find_node(key);
+        if (node == nil) {
             throw std::runtime_error("Nodo no encontrado");
         }
-        if (node->right != nullptr)
-            return minimum(node->right)->key;
-        Node<T>* parent = node->parent;
-        while (parent != nullptr && node == parent->right) {
-            node = parent;
-            parent = parent->parent;
-        }
-        if (parent == nullptr)
+        node_ptr next = next_node(node);
+        if (next == nil)
             throw std::runtime_error("No tiene sucesor");
-        return parent->key;
+        return this->key(next);
     }
 
     // Complejidad: O(log n) - búsqueda del nodo O(log n) + encontrar máximo O(log n) = O(log n)
     // o recorrido hacia arriba O(log n)
-    T predecesor(T key) {
-        Node<T>* node = find_node(key);
-        if (node == nullptr) {
+    T predecesor(const T& key) {
+        node_ptr node = find_node(key);
+        if (node == nil) {
             throw std::runtime_error("Nodo no encontrado");
         }
-        if (node->left != nullptr)
-            return maximum(node->left)->key;
-        Node<T>* parent = node->parent;
-        while (parent != nullptr && node == parent->left) {
-            node = parent;
-            parent = parent->parent;
-        }
-        if (parent == nullptr)
+        node_ptr prev = prev_node(node);
+        if (prev == nil)
             throw std::runtime_error("No tiene predecesor");
-        return parent->key;
+        return this->key(prev);
     }
 
     // Complejidad: O(n) - recorre todos los nodos del árbol para imprimirlos
     void print_tree() {
-        if (root == nullptr) {
+        if (root == nil) {
             std::cout << "Árbol vacío" << std::endl;
             return;
         }
@@ -389,4 +2182,20 @@ public:
         std::cout << std::endl;
     }
 };
+
+// Variantes con nodo compacto (ver rb_compact_layout y rb_index_layout)
+template<typename T>
+using RB_compact_tree = RB_tree<T, std::less<T>, slab_pool, rb_compact_layout>;
+template<typename T>
+using RB_index_tree = RB_tree<T, std::less<T>, index_pool, rb_index_layout>;
+// Árbol de estadísticos de orden: rank, select y count_range en O(log n)
+template<typename T>
+using RB_order_tree = RB_tree<T, std::less<T>, slab_pool, rb_pointer_layout, rb_order_statistics>;
+// Árbol de intervalos [first, second]: overlapping(a, b, f) en O(log n + k)
+template<typename E>
+using RB_interval_tree = RB_tree<std::pair<E, E>, std::less<std::pair<E, E>>, slab_pool, rb_pointer_layout, rb_interval_max<E>>;
+// Pares (clave, valor) ordenados por clave con el agregado Monoid de cada subárbol:
+// aggregate(lo, hi) en O(log n). Con rb_no_monoid es un RB_tree de pares sin campo extra
+template<typename K, typename V, typename Monoid = rb_sum_monoid<V>, typename Compare = std::less<K>>
+using RB_aggregate_tree = RB_tree<std::pair<K, V>, rb_first_less<Compare>, slab_pool, rb_pointer_layout, rb_monoid_aggregate<Monoid>>;
 #endif //RB_TREE_H
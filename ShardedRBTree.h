@@ -0,0 +1,335 @@
+#ifndef SHARDED_RB_TREE_H
+#define SHARDED_RB_TREE_H
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "RB_tree.h"
+
+// RB_tree repartido por rangos de clave entre P shards, cada uno con su propio
+// RB_tree y su propio shared_mutex. Con ConcurrentRBTree todos los escritores se
+// serializan en un único lock (y los fixups rotan cerca de la misma raíz); aquí dos
+// escritores solo se esperan si sus claves caen en el mismo rango.
+//
+// Enrutado: P - 1 separadores ordenados; el shard i guarda las claves k con
+// separador[i - 1] <= k < separador[i]. Se eligen como cuantiles de una muestra de
+// claves (constructor con muestra) o, sin muestra, empiezan todos en T{} y se van
+// ajustando solos.
+//
+// Reequilibrado en línea: cuando un shard supera 1.5 veces la media (más un
+// margen), la mitad de su diferencia con el shard más pequeño se traspasa hacia este
+// con split/join, de vecino en vecino: cada shard intermedio entrega por un lado
+// tantas claves como recibe por el otro y se mueven los separadores entre ellos.
+// Solo se bloquean los shards de ese tramo.
+//
+// Los separadores se leen sin lock: una operación elige su shard i, lo bloquea y
+// comprueba que separador[i - 1] <= clave < separador[i]. Esos dos separadores solo
+// cambian con el lock de i, así que si se cumple, i es el shard correcto hasta
+// soltarlo; si no (un reequilibrado los movió entre medias), vuelve a empezar. Un
+// reequilibrado no frena a las operaciones sobre shards fuera de su tramo. Con
+// claves que no son trivialmente copiables (o que std::atomic_ref no admite con su
+// alineación) el enrutado se protege con un shared_mutex.
+//
+// Los recorridos por rango bloquean en modo compartido, en orden, todos los shards
+// que abarcan, así que ven un estado consistente y siempre salen ordenados.
+template<typename T, typename Compare = std::less<T>>
+class ShardedRBTree {
+public:
+    using tree_type = RB_tree<T, Compare>;
+
+    // true si los separadores se leen sin lock (ver comentario de cabecera)
+    static constexpr bool optimistic_routing = [] {
+        if constexpr (std::is_trivially_copyable_v<T>)
+            return std::atomic_ref<T>::required_alignment <= alignof(T);
+        else
+            return false;
+    }();
+
+private:
+    // Un shard por línea de caché: los locks de shards vecinos no comparten fallos
+    struct alignas(64) shard {
+        mutable std::shared_mutex mutex;
+        tree_type tree;
+        std::atomic<std::size_t> count{0}; // copia de tree.size() legible sin el lock
+    };
+
+    // Un shard no se reequilibra por debajo de este tamaño
+    static constexpr std::size_t rebalance_slack = 1024;
+
+    std::size_t shard_count;
+    std::unique_ptr<shard[]> shards;
+    std::vector<T> splitters; // shard_count - 1, ordenados
+    [[no_unique_address]] Compare comp;
+    mutable std::shared_mutex routing_mutex; // solo sin optimistic_routing
+    std::mutex rebalance_mutex;              // un reequilibrado a la vez
+
+    // Con optimistic_routing los separadores se leen sin lock mientras un
+    // reequilibrado los escribe: ambos lados pasan por atomic_ref (relaxed; el valor
+    // leído solo es una pista que se comprueba con el lock del shard)
+    T load_splitter(std::size_t i) const {
+        return std::atomic_ref<T>(const_cast<T&>(splitters[i])).load(std::memory_order_relaxed);
+    }
+    void store_splitter(std::size_t i, const T& key) {
+        if constexpr (optimistic_routing)
+            std::atomic_ref<T>(splitters[i]).store(key, std::memory_order_relaxed);
+        else
+            splitters[i] = key;
+    }
+
+    // Complejidad: O(log P) - índice del shard de key (el primer separador > key)
+    std::size_t route(const T& key) const {
+        if constexpr (optimistic_routing) {
+            std::size_t first = 0, n = splitters.size();
+            while (n > 0) {
+                std::size_t half = n / 2;
+                if (comp(key, load_splitter(first + half))) {
+                    n = half;
+                } else {
+                    first += half + 1;
+                    n -= half + 1;
+                }
+            }
+            return first;
+        } else {
+            return static_cast<std::size_t>(std::upper_bound(splitters.begin(), splitters.end(), key, comp) -
+                                            splitters.begin());
+        }
+    }
+
+    // Complejidad: O(1) - true si key cae en el rango del shard i. Con el lock de i:
+    // los dos separadores que mira solo cambian con ese lock tomado
+    bool owns(std::size_t i, const T& key) const {
+        return (i == 0 || !comp(key, splitters[i - 1])) && (i + 1 == shard_count || comp(key, splitters[i]));
+    }
+
+    // Complejidad: O(log P) + f - bloquea el shard de key (en exclusiva o compartido)
+    // con el enrutado estable y ejecuta f(shard, índice)
+    template<typename Lock, typename F>
+    decltype(auto) with_shard(const T& key, F&& f) const {
+        if constexpr (optimistic_routing) {
+            while (true) {
+                std::size_t i = route(key);
+                Lock lock(shards[i].mutex);
+                if (owns(i, key)) return f(shards[i], i);
+            }
+        } else {
+            std::shared_lock routing(routing_mutex);
+            std::size_t i = route(key);
+            Lock lock(shards[i].mutex);
+            return f(shards[i], i);
+        }
+    }
+
+    // Complejidad: O(P)
+    std::size_t total() const {
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < shard_count; ++i) n += shards[i].count.load(std::memory_order_relaxed);
+        return n;
+    }
+
+    // Complejidad: O(1)
+    bool oversized(std::size_t n, std::size_t all) const {
+        return n > all / shard_count + all / shard_count / 2 + rebalance_slack;
+    }
+
+    // Complejidad: O(m + log n) - pasa las m claves mayores de shards[a] a shards[a + 1]
+    // y mueve el separador entre ambos (split copia la parte que sale del slab_pool).
+    // Devuelve cuántas pasaron (con duplicados en el corte pueden ser más).
+    std::size_t shift_up(std::size_t a, std::size_t m) {
+        tree_type& from = shards[a].tree;
+        tree_type& to = shards[a + 1].tree;
+        m = std::min(m, from.size());
+        if (m == 0) return 0;
+        auto it = from.end();
+        for (std::size_t k = 0; k < m; ++k) --it;
+        T boundary = *it;
+        tree_type upper = from.split(boundary);
+        std::size_t moved = upper.size();
+        upper.join(std::move(to));
+        to = std::move(upper);
+        store_splitter(a, boundary);
+        return moved;
+    }
+
+    // Complejidad: O(m + log n) - pasa las m claves menores de shards[a + 1] a shards[a].
+    // El nuevo separador es la primera clave que se queda, así que al menos una se queda.
+    std::size_t shift_down(std::size_t a, std::size_t m) {
+        tree_type& to = shards[a].tree;
+        tree_type& from = shards[a + 1].tree;
+        m = std::min(m, from.size() == 0 ? 0 : from.size() - 1);
+        if (m == 0) return 0;
+        auto it = from.begin();
+        for (std::size_t k = 0; k < m; ++k) ++it;
+        T boundary = *it;
+        tree_type upper = from.split(boundary);
+        std::size_t moved = from.size();
+        to.join(std::move(from));
+        from = std::move(upper);
+        store_splitter(a, boundary);
+        return moved;
+    }
+
+    // Complejidad: O(d (m + log n)) con m las claves traspasadas y d la distancia al
+    // shard más pequeño. Se llama sin ningún lock de shard tomado.
+    void rebalance(std::size_t i) {
+        if (shard_count < 2) return;
+        std::unique_lock guard(rebalance_mutex, std::try_to_lock);
+        if (!guard) return; // otro hilo ya está reequilibrando
+        if (!oversized(shards[i].count.load(std::memory_order_relaxed), total())) return;
+        // Destino: el shard más pequeño (a igualdad, el más cercano)
+        std::size_t k = i == 0 ? 1 : 0;
+        auto distance = [&](std::size_t x) { return x > i ? x - i : i - x; };
+        for (std::size_t x = 0; x < shard_count; ++x) {
+            if (x == i) continue;
+            std::size_t cx = shards[x].count.load(std::memory_order_relaxed);
+            std::size_t ck = shards[k].count.load(std::memory_order_relaxed);
+            if (cx < ck || (cx == ck && distance(x) < distance(k))) k = x;
+        }
+        std::size_t lo = std::min(i, k), hi = std::max(i, k);
+
+        std::unique_lock<std::shared_mutex> routing;
+        if constexpr (!optimistic_routing) routing = std::unique_lock(routing_mutex);
+        // Siempre en orden de índice: ningún otro hilo toma varios shards en orden inverso
+        std::vector<std::unique_lock<std::shared_mutex>> locks;
+        for (std::size_t x = lo; x <= hi; ++x) locks.emplace_back(shards[x].mutex);
+        std::size_t from = shards[i].tree.size(), to = shards[k].tree.size();
+        if (from <= to + 1) return;
+        std::size_t move = (from - to) / 2;
+
+        // Cada paso entrega lo que recibió el anterior: los intermediarios no cambian de tamaño
+        if (k > i)
+            for (std::size_t a = i; a < k && move != 0; ++a) move = shift_up(a, move);
+        else
+            for (std::size_t a = i; a > k && move != 0; --a) move = shift_down(a - 1, move);
+        for (std::size_t x = lo; x <= hi; ++x)
+            shards[x].count.store(shards[x].tree.size(), std::memory_order_relaxed);
+    }
+
+    // Complejidad: O(1) - tras una inserción, cada 1024 claves del shard mira si toca reequilibrar
+    void after_insert(std::size_t i, std::size_t n) {
+        if (n % rebalance_slack == 0 && oversized(n, total())) rebalance(i);
+    }
+
+public:
+    // Dos shards por hilo hardware: con claves uniformes, dos escritores rara vez coinciden
+    static std::size_t default_shards() {
+        unsigned cores = std::thread::hardware_concurrency();
+        return 2 * static_cast<std::size_t>(cores == 0 ? 1 : cores);
+    }
+
+    // Complejidad: O(P) - separadores T{}: se ajustan con el reequilibrado
+    explicit ShardedRBTree(std::size_t shards_ = default_shards(), const Compare& c = Compare())
+        : shard_count(std::max<std::size_t>(shards_, 1)), shards(new shard[shard_count]),
+          splitters(shard_count - 1), comp(c) {}
+
+    // Complejidad: O(s log s) con s el tamaño de la muestra - separadores en los
+    // cuantiles de [sample_first, sample_last)
+    template<typename It>
+    ShardedRBTree(std::size_t shards_, It sample_first, It sample_last, const Compare& c = Compare())
+        : ShardedRBTree(shards_, c) {
+        std::vector<T> sample(sample_first, sample_last);
+        if (sample.empty()) return;
+        std::sort(sample.begin(), sample.end(), comp);
+        for (std::size_t i = 1; i < shard_count; ++i) splitters[i - 1] = sample[i * sample.size() / shard_count];
+    }
+
+    ShardedRBTree(const ShardedRBTree&) = delete;
+    ShardedRBTree& operator=(const ShardedRBTree&) = delete;
+
+    // Complejidad: O(log(n / P)) - en exclusiva solo en el shard de key
+    void add_leaf(const T& key) {
+        auto [i, n] = with_shard<std::unique_lock<std::shared_mutex>>(key, [&](shard& s, std::size_t i) {
+            s.tree.add_leaf(key);
+            s.count.store(s.tree.size(), std::memory_order_relaxed);
+            return std::pair{i, s.tree.size()};
+        });
+        after_insert(i, n);
+    }
+    // Complejidad: O(log(n / P)) - false si la clave ya estaba
+    bool insert_unique(const T& key) {
+        auto [i, n, inserted] = with_shard<std::unique_lock<std::shared_mutex>>(key, [&](shard& s, std::size_t i) {
+            bool ok = s.tree.insert_unique(key).second;
+            s.count.store(s.tree.size(), std::memory_order_relaxed);
+            return std::tuple{i, s.tree.size(), ok};
+        });
+        if (inserted) after_insert(i, n);
+        return inserted;
+    }
+    // Complejidad: O(log(n / P))
+    bool delete_leaf(const T& key) {
+        return with_shard<std::unique_lock<std::shared_mutex>>(key, [&](shard& s, std::size_t) {
+            bool erased = s.tree.delete_leaf(key);
+            s.count.store(s.tree.size(), std::memory_order_relaxed);
+            return erased;
+        });
+    }
+
+    // Complejidad: O(log(n / P)) - compartido en el shard de key
+    bool find(const T& key) const {
+        return with_shard<std::shared_lock<std::shared_mutex>>(
+            key, [&](const shard& s, std::size_t) { return s.tree.find(key); });
+    }
+
+    // Complejidad: O(k + S log(n / P)) con S los shards que abarca [lo, hi] - llama a
+    // f(clave) para cada clave del intervalo cerrado en orden. Los shards se bloquean
+    // en modo compartido, de menor a mayor, durante todo el recorrido (f no debe
+    // escribir en el árbol).
+    template<typename F>
+    void for_each_in_range(const T& lo, const T& hi, F&& f) const {
+        if (comp(hi, lo)) return;
+        std::vector<std::shared_lock<std::shared_mutex>> locks;
+        std::shared_lock<std::shared_mutex> routing;
+        std::size_t first, last;
+        if constexpr (!optimistic_routing) routing = std::shared_lock(routing_mutex);
+        while (true) {
+            locks.clear();
+            first = route(lo);
+            last = route(hi);
+            if (last < first) continue; // separadores leídos a medias de un reequilibrado
+            for (std::size_t i = first; i <= last; ++i) locks.emplace_back(shards[i].mutex);
+            // Con first..last bloqueados los separadores entre ellos están quietos y
+            // ordenados: basta con que lo y hi caigan en los extremos
+            if (owns(first, lo) && owns(last, hi)) break;
+        }
+        for (std::size_t i = first; i <= last; ++i) {
+            const tree_type& t = shards[i].tree;
+            for (auto it = t.lower_bound(lo), end = t.upper_bound(hi); it != end; ++it) f(*it);
+        }
+    }
+
+    // Complejidad: O(n) - todas las claves en orden (ver for_each_in_range)
+    template<typename F>
+    void for_each(F&& f) const {
+        std::vector<std::shared_lock<std::shared_mutex>> locks;
+        std::shared_lock<std::shared_mutex> routing;
+        if constexpr (!optimistic_routing) routing = std::shared_lock(routing_mutex);
+        // Con todos los shards bloqueados ningún reequilibrado puede estar a medias
+        for (std::size_t i = 0; i < shard_count; ++i) locks.emplace_back(shards[i].mutex);
+        for (std::size_t i = 0; i < shard_count; ++i)
+            for (const T& k : shards[i].tree) f(k);
+    }
+
+    // Complejidad: O(P) - aproximado si hay escrituras concurrentes
+    std::size_t size() const {
+        return total();
+    }
+    bool empty() const {
+        return size() == 0;
+    }
+    std::size_t shards_count() const {
+        return shard_count;
+    }
+    // Complejidad: O(1) - claves del shard i, para ver el reparto
+    std::size_t shard_size(std::size_t i) const {
+        if (i >= shard_count) throw std::out_of_range("shard_size: índice fuera de rango");
+        return shards[i].count.load(std::memory_order_relaxed);
+    }
+};
+#endif //SHARDED_RB_TREE_H
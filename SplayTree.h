@@ -0,0 +1,318 @@
+#ifndef SPLAY_TREE_H
+#define SPLAY_TREE_H
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "NodePool.h"
+#include "TreeCompare.h"
+#include "TreeStats.h"
+
+// Árbol splay genérico, solo cabecera y sin despacho virtual: find, insert y remove
+// se pueden inlinear en el bucle que los llama. Mismo algoritmo que la versión
+// original de Splay.h (splay recursivo de abajo arriba, borrado por sucesor que
+// luego hace splay del padre), pero con cualquier tipo de clave y con los nodos en
+// un pool en lugar de malloc/free. splay_tree_implementation (Splay.h) es ahora un
+// adaptador de SplayTree<int> para quien use la interfaz virtual splay_tree.
+//
+// Compare: orden de las claves (std::less<T> por defecto, con comparación de tres vías)
+// Pool: política de reserva de nodos (slab_pool por defecto, heap_pool para un
+// new/delete por nodo; ver NodePool.h)
+// Stats: instrumentación de rotaciones, descensos y splays (tree_no_stats, sin coste,
+// o tree_stats; ver TreeStats.h)
+// Sin duplicados, como AVL.
+template<typename T, typename Compare = std::less<T>, template<typename> class Pool = slab_pool,
+         typename Stats = tree_no_stats>
+class SplayTree {
+private:
+    struct node {
+        T key;
+        node* left;
+        node* right;
+
+        explicit node(const T& k) : key(k), left(nullptr), right(nullptr) {}
+    };
+
+    node* root = nullptr;
+    std::size_t node_count = 0;
+    Pool<node> pool;
+    [[no_unique_address]] Compare comp;
+    [[no_unique_address]] Stats counters;
+
+    node* rotate_left(node* x) {
+        counters.rotation();
+        node* temp = x->right;
+        x->right = temp->left;
+        temp->left = x;
+        return temp;
+    }
+
+    node* rotate_right(node* y) {
+        counters.rotation();
+        node* temp = y->left;
+        y->left = temp->right;
+        temp->right = y;
+        return temp;
+    }
+
+    // Complejidad: O(profundidad) - sube key (o el último nodo visitado si no está)
+    // a la raíz del subárbol r con pasos zig-zig / zig-zag
+    node* splay(node* r, const T& key) {
+        if (r == nullptr) return r;
+        auto c = tree_compare(comp, key, r->key);
+        if (c == 0) return r;
+        if (c < 0) {
+            if (r->left == nullptr) return r;
+            auto cl = tree_compare(comp, key, r->left->key);
+            if (cl < 0) { // zig-zig
+                r->left->left = splay(r->left->left, key);
+                r = rotate_right(r);
+            } else if (cl > 0) { // zig-zag
+                r->left->right = splay(r->left->right, key);
+                if (r->left->right != nullptr) r->left = rotate_left(r->left);
+            }
+            return r->left != nullptr ? rotate_right(r) : r;
+        }
+        if (r->right == nullptr) return r;
+        auto cr = tree_compare(comp, key, r->right->key);
+        if (cr > 0) { // zig-zig
+            r->right->right = splay(r->right->right, key);
+            r = rotate_left(r);
+        } else if (cr < 0) { // zig-zag
+            r->right->left = splay(r->right->left, key);
+            if (r->right->left != nullptr) r->right = rotate_right(r->right);
+        }
+        return r->right != nullptr ? rotate_left(r) : r;
+    }
+
+    // Cada rotación de un splay sube un nivel el nodo buscado: las rotaciones del
+    // splay son su profundidad
+    void splay_root(const T& key) {
+        if constexpr (Stats::enabled) {
+            std::uint64_t before = counters.rotations;
+            root = splay(root, key);
+            counters.splay_depth(counters.rotations - before);
+        } else {
+            root = splay(root, key);
+        }
+    }
+
+    // Complejidad: O(profundidad) - borra r, la raíz, sin splay: con dos hijos le pasa
+    // la clave del sucesor y desengancha el sucesor. Devuelve la nueva raíz.
+    node* delete_root(node* r) {
+        if (r->left == nullptr || r->right == nullptr) {
+            node* temp = r->left != nullptr ? r->left : r->right;
+            pool.destroy(r);
+            return temp;
+        }
+        node* parent = nullptr;
+        node* successor = r->right;
+        while (successor->left != nullptr) {
+            parent = successor;
+            successor = successor->left;
+        }
+        r->key = std::move(successor->key);
+        if (parent != nullptr)
+            parent->left = successor->right;
+        else
+            r->right = successor->right;
+        pool.destroy(successor);
+        return r;
+    }
+
+    // Complejidad: O(profundidad) - borra key de debajo de la raíz (que no la contiene)
+    // y devuelve el padre del nodo borrado, o el último nodo visitado si key no está
+    node* delete_below_root(const T& key) {
+        node* parent = nullptr;
+        node* r = root;
+        std::size_t depth = 0;
+        while (r != nullptr) {
+            ++depth;
+            auto c = tree_compare(comp, key, r->key);
+            if (c == 0) break;
+            parent = r;
+            r = c > 0 ? r->right : r->left;
+        }
+        counters.search_path(depth);
+        if (r == nullptr) return parent;
+        node* replacement = r;
+        if (r->left == nullptr || r->right == nullptr) {
+            replacement = r->left != nullptr ? r->left : r->right;
+            pool.destroy(r);
+        } else {
+            node* p = nullptr;
+            node* successor = r->right;
+            while (successor->left != nullptr) {
+                p = successor;
+                successor = successor->left;
+            }
+            r->key = std::move(successor->key);
+            if (p == nullptr)
+                r->right = successor->right;
+            else
+                p->left = successor->right;
+            pool.destroy(successor);
+        }
+        if (parent->left == r)
+            parent->left = replacement;
+        else
+            parent->right = replacement;
+        --node_count;
+        return parent;
+    }
+
+    // Complejidad: O(n) - destruye los nodos del subárbol uno a uno
+    void destroy_subtree(node* r) {
+        if (r == nullptr) return;
+        destroy_subtree(r->left);
+        destroy_subtree(r->right);
+        pool.destroy(r);
+    }
+
+    void pre(node* r, std::vector<T>& out) const {
+        if (r == nullptr) return;
+        out.push_back(r->key);
+        pre(r->left, out);
+        pre(r->right, out);
+    }
+    void in(node* r, std::vector<T>& out) const {
+        if (r == nullptr) return;
+        in(r->left, out);
+        out.push_back(r->key);
+        in(r->right, out);
+    }
+    void post(node* r, std::vector<T>& out) const {
+        if (r == nullptr) return;
+        post(r->left, out);
+        post(r->right, out);
+        out.push_back(r->key);
+    }
+
+public:
+    SplayTree() = default;
+    SplayTree(const SplayTree&) = delete;
+    SplayTree& operator=(const SplayTree&) = delete;
+
+    // Complejidad: O(1) - el pool cambia de dueño con sus nodos; other queda vacío
+    SplayTree(SplayTree&& other) noexcept
+        : root(other.root), node_count(other.node_count), pool(std::move(other.pool)), comp(std::move(other.comp)) {
+        other.root = nullptr;
+        other.node_count = 0;
+    }
+    // Complejidad: la de clear() más O(1)
+    SplayTree& operator=(SplayTree&& other) noexcept {
+        if (this != &other) {
+            clear();
+            root = other.root;
+            node_count = other.node_count;
+            pool = std::move(other.pool);
+            comp = std::move(other.comp);
+            other.root = nullptr;
+            other.node_count = 0;
+        }
+        return *this;
+    }
+
+    // Complejidad: O(#slabs) con slab_pool y claves trivialmente destructibles,
+    // O(n) en otro caso (hay que destruir cada nodo)
+    ~SplayTree() {
+        clear();
+    }
+
+    // Complejidad: igual que el destructor
+    void clear() {
+        if constexpr (!(Pool<node>::bulk_release && std::is_trivially_destructible_v<node>))
+            destroy_subtree(root);
+        pool.release();
+        root = nullptr;
+        node_count = 0;
+    }
+
+    // Complejidad: O(log n) amortizado - sube key a la raíz si está; si no, el último
+    // nodo visitado
+    bool find(const T& key) {
+        if (root == nullptr) return false;
+        splay_root(key);
+        return tree_compare(comp, root->key, key) == 0;
+    }
+
+    // Complejidad: O(log n) amortizado - inserta como en un BST y sube el nodo (o el
+    // que ya tenía la clave) a la raíz
+    void insert(const T& key) {
+        if (root == nullptr) {
+            root = pool.create(key);
+            node_count = 1;
+            return;
+        }
+        node* parent = nullptr;
+        node* r = root;
+        bool go_left = false;
+        std::size_t depth = 0;
+        while (r != nullptr) {
+            ++depth;
+            auto c = tree_compare(comp, key, r->key);
+            if (c == 0) break;
+            parent = r;
+            go_left = c < 0;
+            r = go_left ? r->left : r->right;
+        }
+        counters.search_path(depth);
+        if (r == nullptr) {
+            node* new_node = pool.create(key);
+            if (go_left)
+                parent->left = new_node;
+            else
+                parent->right = new_node;
+            ++node_count;
+        }
+        splay_root(key);
+    }
+
+    // Complejidad: O(log n) amortizado - borra key como en un BST (con dos hijos, el
+    // sucesor ocupa su lugar) y sube el padre del nodo borrado a la raíz; si key no
+    // está, sube el último nodo visitado, como find. Si key es la raíz no hay splay.
+    void remove(const T& key) {
+        if (root == nullptr) return;
+        if (tree_compare(comp, root->key, key) == 0) {
+            root = delete_root(root);
+            --node_count;
+            return;
+        }
+        node* parent = delete_below_root(key);
+        splay_root(parent->key);
+    }
+
+    std::size_t size() const {
+        return node_count;
+    }
+    bool empty() const {
+        return node_count == 0;
+    }
+
+    std::vector<T> pre_order() const {
+        std::vector<T> out;
+        pre(root, out);
+        return out;
+    }
+    std::vector<T> in_order() const {
+        std::vector<T> out;
+        in(root, out);
+        return out;
+    }
+    std::vector<T> post_order() const {
+        std::vector<T> out;
+        post(root, out);
+        return out;
+    }
+
+    // Contadores de la política Stats (ver TreeStats.h)
+    const Stats& stats() const {
+        return counters;
+    }
+    void reset_stats() {
+        counters.reset();
+    }
+};
+#endif //SPLAY_TREE_H
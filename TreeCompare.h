@@ -0,0 +1,33 @@
+#ifndef TREE_COMPARE_H
+#define TREE_COMPARE_H
+#include <compare>
+#include <functional>
+#include <type_traits>
+
+// Comparación de tres vías para los bucles de búsqueda de RB_tree, AVL y Splay.
+// Con el comparador por defecto (std::less<T> o std::less<>) y claves con
+// operator<=>, cada nivel hace una sola comparación (un solo recorrido de una
+// std::string, por ejemplo). Con cualquier otro comparador se cae en dos
+// llamadas comp(a, b) y comp(b, a).
+
+template<typename Compare>
+inline constexpr bool is_default_less = false;
+template<typename T>
+inline constexpr bool is_default_less<std::less<T>> = true;
+
+// Complejidad: O(1) comparaciones de clave (una con <=>, dos con el comparador)
+template<typename Compare, typename A, typename B>
+inline std::weak_ordering tree_compare(const Compare& comp, const A& a, const B& b) {
+    if constexpr (is_default_less<Compare> && std::three_way_comparable_with<A, B, std::weak_ordering>) {
+        return a <=> b;
+    } else {
+        if (comp(a, b)) return std::weak_ordering::less;
+        if (comp(b, a)) return std::weak_ordering::greater;
+        return std::weak_ordering::equivalent;
+    }
+}
+
+// true si el comparador admite búsquedas con claves de otro tipo (std::less<>, etc.)
+template<typename Compare>
+concept transparent_compare = requires { typename Compare::is_transparent; };
+#endif //TREE_COMPARE_H
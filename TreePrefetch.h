@@ -0,0 +1,18 @@
+#ifndef TREE_PREFETCH_H
+#define TREE_PREFETCH_H
+#include <cstddef>
+
+// Prefetch de lectura de una línea de caché (no hace nada si el compilador no lo soporta)
+inline void tree_prefetch(const void* p) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(p, 0, 3);
+#else
+    (void)p;
+#endif
+}
+
+// Número de búsquedas que find_many avanza a la vez. Con ~16 descensos
+// independientes en vuelo la latencia de cada fallo de caché se solapa con las
+// comparaciones de los demás sin desbordar los buffers de fallos del núcleo.
+inline constexpr std::size_t tree_find_group = 16;
+#endif //TREE_PREFETCH_H
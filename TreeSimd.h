@@ -0,0 +1,61 @@
+#ifndef TREE_SIMD_H
+#define TREE_SIMD_H
+#include <bit>
+#include <cstddef>
+#include <type_traits>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Búsqueda dentro de un nodo de muchas claves (FrozenBlockIndex, BTree) sin ramas:
+// la posición de key es cuántas claves del nodo son < key. Con AVX2 ese conteo son
+// N / (32 / sizeof(T)) comparaciones de 256 bits y un popcount por cada una; sin
+// AVX2 es un bucle de comparaciones que el compilador puede vectorizar.
+// Solo para claves enteras de 4 u 8 bytes ordenadas con std::less. Los huecos del
+// nodo deben rellenarse con el máximo de T, que nunca es < key.
+
+template<typename T>
+inline constexpr bool simd_rank_key = std::is_integral_v<T> && (sizeof(T) == 4 || sizeof(T) == 8);
+
+// Claves por registro de 256 bits: N debe ser múltiplo de esto
+template<typename T>
+inline constexpr std::size_t simd_rank_lane = 32 / sizeof(T);
+
+// Complejidad: O(N) sin ramas - número de claves de p[0..N) que son < key.
+// p alineado a 32 bytes
+template<std::size_t N, typename T>
+inline std::size_t simd_rank(const T* p, T key) {
+    static_assert(simd_rank_key<T> && N % simd_rank_lane<T> == 0, "simd_rank: N claves enteras de 4 u 8 bytes");
+#ifdef __AVX2__
+    std::size_t r = 0;
+    if constexpr (sizeof(T) == 4) {
+        __m256i k = _mm256_set1_epi32(static_cast<int>(key));
+        // AVX2 solo compara con signo: con claves sin signo se invierte el bit alto de ambos lados
+        const __m256i flip = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+        if constexpr (std::is_unsigned_v<T>) k = _mm256_xor_si256(k, flip);
+        for (std::size_t i = 0; i < N; i += 8) {
+            __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(p + i));
+            if constexpr (std::is_unsigned_v<T>) a = _mm256_xor_si256(a, flip);
+            unsigned m = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(k, a))));
+            r += static_cast<std::size_t>(std::popcount(m));
+        }
+    } else {
+        __m256i k = _mm256_set1_epi64x(static_cast<long long>(key));
+        const __m256i flip = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ull));
+        if constexpr (std::is_unsigned_v<T>) k = _mm256_xor_si256(k, flip);
+        for (std::size_t i = 0; i < N; i += 4) {
+            __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(p + i));
+            if constexpr (std::is_unsigned_v<T>) a = _mm256_xor_si256(a, flip);
+            unsigned m = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(k, a))));
+            r += static_cast<std::size_t>(std::popcount(m));
+        }
+    }
+    return r;
+#else
+    std::size_t r = 0;
+    for (std::size_t i = 0; i < N; ++i)
+        r += static_cast<std::size_t>(p[i] < key);
+    return r;
+#endif
+}
+#endif //TREE_SIMD_H
@@ -0,0 +1,145 @@
+#ifndef TREE_SNAPSHOT_H
+#define TREE_SNAPSHOT_H
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Formato binario de RB_tree::save / RB_tree::load:
+//   cabecera (32 bytes) | count claves ordenadas (count * key_bytes)
+//   | opcional: forma del árbol, 4 bits por nodo en preorden (dos nodos por byte):
+//     bit 0 = tiene hijo izquierdo, bit 1 = tiene hijo derecho, bit 2 = rojo.
+// Las claves se guardan tal cual están en memoria (T trivialmente copiable) y
+// en el orden de bytes de la máquina que escribió; load lo comprueba.
+struct tree_snapshot_header {
+    char magic[8];              // "RBSNAP1"
+    std::uint32_t byte_order;   // tree_snapshot_byte_order escrito en el orden nativo
+    std::uint32_t key_bytes;    // sizeof(T)
+    std::uint64_t count;        // número de claves
+    std::uint32_t flags;        // tree_snapshot_shape si hay forma guardada
+    std::uint32_t reserved;
+};
+static_assert(sizeof(tree_snapshot_header) == 32, "la cabecera mide 32 bytes: las claves quedan alineadas");
+
+inline constexpr char tree_snapshot_magic[8] = {'R', 'B', 'S', 'N', 'A', 'P', '1', '\0'};
+inline constexpr std::uint32_t tree_snapshot_byte_order = 0x01020304u;
+inline constexpr std::uint32_t tree_snapshot_shape = 1u;
+
+// Archivo completo proyectado en memoria de solo lectura (mmap en POSIX,
+// MapViewOfFile en Windows; en otras plataformas se lee a un búfer alineado).
+// Las páginas se cargan bajo demanda desde la caché del sistema: leer el
+// snapshot no copia las claves a un búfer intermedio.
+class mapped_file {
+private:
+    const std::byte* base = nullptr;
+    std::size_t length = 0;
+#if defined(_WIN32)
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+    void unmap() {
+#if defined(_WIN32)
+        if (base != nullptr) UnmapViewOfFile(base);
+        if (mapping != nullptr) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#elif defined(__unix__) || defined(__APPLE__)
+        if (base != nullptr) munmap(const_cast<std::byte*>(base), length);
+#else
+        if (base != nullptr) ::operator delete(const_cast<std::byte*>(base), std::align_val_t(64));
+#endif
+        base = nullptr;
+        length = 0;
+    }
+
+public:
+    // Complejidad: O(1) con mmap (las páginas se leen al tocarlas), O(tamaño) sin él
+    explicit mapped_file(const std::string& path) {
+#if defined(_WIN32)
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("mapped_file: no se puede abrir " + path);
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            unmap();
+            throw std::runtime_error("mapped_file: no se puede leer el tamaño de " + path);
+        }
+        length = static_cast<std::size_t>(size.QuadPart);
+        if (length == 0) return;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr) base = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (base == nullptr) {
+            unmap();
+            throw std::runtime_error("mapped_file: no se puede proyectar " + path);
+        }
+#elif defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("mapped_file: no se puede abrir " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("mapped_file: no se puede leer el tamaño de " + path);
+        }
+        length = static_cast<std::size_t>(st.st_size);
+        if (length != 0) {
+            int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+            flags |= MAP_POPULATE; // se va a leer entero: mejor cargarlo de una vez que fallo a fallo
+#endif
+            void* p = ::mmap(nullptr, length, PROT_READ, flags, fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                length = 0;
+                throw std::runtime_error("mapped_file: no se puede proyectar " + path);
+            }
+            base = static_cast<const std::byte*>(p);
+        }
+        ::close(fd); // la proyección sigue siendo válida sin el descriptor
+#else
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) throw std::runtime_error("mapped_file: no se puede abrir " + path);
+        length = static_cast<std::size_t>(in.tellg());
+        if (length == 0) return;
+        std::byte* buffer = static_cast<std::byte*>(::operator new(length, std::align_val_t(64)));
+        base = buffer;
+        in.seekg(0);
+        if (!in.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(length))) {
+            unmap();
+            throw std::runtime_error("mapped_file: error al leer " + path);
+        }
+#endif
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    ~mapped_file() {
+        unmap();
+    }
+
+    // Complejidad: O(1) - inicio del archivo, alineado al menos a 64 bytes
+    const std::byte* data() const {
+        return base;
+    }
+    std::size_t size() const {
+        return length;
+    }
+};
+#endif //TREE_SNAPSHOT_H
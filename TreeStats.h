@@ -0,0 +1,102 @@
+#ifndef TREE_STATS_H
+#define TREE_STATS_H
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Políticas de instrumentación (parámetro Stats de RB_tree, AVL y basic_splay_tree).
+// El árbol llama a los ganchos en cada rotación, en cada caso de los fixups
+// rojo-negro, al terminar cada fixup, cada descenso y cada splay:
+//  - tree_no_stats (por defecto): los ganchos son funciones vacías y el miembro no
+//    ocupa espacio ([[no_unique_address]]): el código generado es el mismo que sin
+//    instrumentación.
+//  - tree_stats: cuenta rotaciones y casos de fixup y guarda histogramas de las
+//    iteraciones de cada fixup, la longitud de cada descenso y la profundidad de
+//    cada splay, para relacionar el trabajo estructural con la latencia.
+//    Sus contadores no están sincronizados: un RB_tree con tree_stats hace en serie
+//    las operaciones de conjuntos que con tree_no_stats reparte entre hilos.
+
+struct tree_no_stats {
+    static constexpr bool enabled = false;
+
+    void rotation() {}
+    void insert_case(int) {}
+    void delete_case(int) {}
+    void fixup_steps(std::size_t) {}
+    void search_path(std::size_t) {}
+    void splay_depth(std::size_t) {}
+    void reset() {}
+};
+
+// Histograma lineal: el cubo i cuenta las muestras que valen i y el último
+// acumula todas las >= buckets - 1 (un árbol balanceado no pasa de ~60 niveles)
+struct tree_histogram {
+    static constexpr std::size_t buckets = 64;
+    std::array<std::uint64_t, buckets> count{};
+    std::uint64_t samples = 0;
+    std::uint64_t total = 0;
+    std::uint64_t max = 0;
+
+    // Complejidad: O(1)
+    void add(std::size_t v) {
+        ++count[v < buckets ? v : buckets - 1];
+        ++samples;
+        total += v;
+        if (v > max) max = v;
+    }
+
+    double mean() const {
+        return samples == 0 ? 0.0 : static_cast<double>(total) / static_cast<double>(samples);
+    }
+
+    // Complejidad: O(buckets) - menor valor v con al menos la fracción p de las muestras <= v
+    std::size_t percentile(double p) const {
+        if (samples == 0) return 0;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < buckets; ++i) {
+            seen += count[i];
+            if (static_cast<double>(seen) >= p * static_cast<double>(samples)) return i;
+        }
+        return buckets - 1;
+    }
+};
+
+struct tree_stats {
+    static constexpr bool enabled = true;
+
+    std::uint64_t rotations = 0;
+    // Casos de add_leaf_fixup (1: recoloreo, 2: rotación doble, 3: rotación simple)
+    // y de delete_leaf_fixup (1: hermano rojo, 2: recoloreo, 3: sobrino lejano
+    // negro, 4: rotación final). El índice 0 no se usa.
+    std::array<std::uint64_t, 4> insert_cases{};
+    std::array<std::uint64_t, 5> delete_cases{};
+    tree_histogram fixup;  // iteraciones del bucle de cada fixup
+    tree_histogram search; // nodos visitados en cada descenso (búsqueda, inserción, borrado)
+    tree_histogram splay;  // rotaciones de cada splay (profundidad del nodo que sube)
+
+    void rotation() { ++rotations; }
+    void insert_case(int c) { ++insert_cases[static_cast<std::size_t>(c)]; }
+    void delete_case(int c) { ++delete_cases[static_cast<std::size_t>(c)]; }
+    void fixup_steps(std::size_t n) { fixup.add(n); }
+    void search_path(std::size_t n) { search.add(n); }
+    void splay_depth(std::size_t n) { splay.add(n); }
+    void reset() { *this = tree_stats(); }
+
+    // Columnas de write_csv, para la cabecera del CSV
+    static const char* csv_columns() {
+        return "Rotations,Insert_case1,Insert_case2,Insert_case3,"
+               "Delete_case1,Delete_case2,Delete_case3,Delete_case4,"
+               "Fixup_mean,Fixup_max,Search_mean,Search_p99,Search_max,Splay_mean,Splay_max";
+    }
+
+    // Complejidad: O(buckets)
+    void write_csv(std::ostream& out) const {
+        out << rotations << ',' << insert_cases[1] << ',' << insert_cases[2] << ',' << insert_cases[3] << ','
+            << delete_cases[1] << ',' << delete_cases[2] << ',' << delete_cases[3] << ',' << delete_cases[4] << ','
+            << fixup.mean() << ',' << fixup.max << ','
+            << search.mean() << ',' << search.percentile(0.99) << ',' << search.max << ','
+            << splay.mean() << ',' << splay.max;
+    }
+};
+#endif //TREE_STATS_H
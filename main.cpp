@@ -5,13 +5,1048 @@
 #include <vector>
 #include <random>
 #include <numeric>
+#include <algorithm>
+#include <string>
+#include <memory>
+#include <span>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <cstdio>
 #include "AVL.h"
+#include "CompactAVL.h"
 #include "Splay.h"
 #include "RB_tree.h"
+#include "ConcurrentRBTree.h"
+#include "PersistentRBTree.h"
+#include "BTree.h"
+#include "MappedRBTree.h"
+#include "ShardedRBTree.h"
 
 using namespace std;
 using namespace std::chrono;
 
+// Benchmark de inserción, búsqueda y eliminación para una variante de RB_tree
+template<typename Tree>
+void benchmark_rb_tree(const string& structure, const string& label, int N, int NUM_ITERATIONS,
+                       ofstream& csv, mt19937& rng, uniform_int_distribution<int>& dist) {
+    vector<double> times_insert, times_search, times_search_batch, times_erase;
+    unique_ptr<bool[]> found(new bool[N]);
+
+    for (int iter = 0; iter < NUM_ITERATIONS; ++iter) {
+        vector<int> data;
+        data.reserve(N);
+        for (int i = 0; i < N; ++i) data.push_back(dist(rng));
+
+        Tree rb;
+        auto start = high_resolution_clock::now();
+        for (int v : data) rb.add_leaf(v);
+        auto end = high_resolution_clock::now();
+        times_insert.push_back(duration_cast<duration<double, micro>>(end - start).count());
+
+        volatile int dummy3 = 0;
+        start = high_resolution_clock::now();
+        for (int v : data) dummy3 += rb.find(v) ? 1 : 0;
+        end = high_resolution_clock::now();
+        times_search.push_back(duration_cast<duration<double, micro>>(end - start).count());
+
+        // Misma búsqueda por lotes con prefetch
+        start = high_resolution_clock::now();
+        rb.find_many(span<const int>(data), span<bool>(found.get(), N));
+        end = high_resolution_clock::now();
+        times_search_batch.push_back(duration_cast<duration<double, micro>>(end - start).count());
+
+        start = high_resolution_clock::now();
+        for (int v : data) rb.delete_leaf(v);
+        end = high_resolution_clock::now();
+        times_erase.push_back(duration_cast<duration<double, micro>>(end - start).count());
+    }
+
+    double avg_insert = accumulate(times_insert.begin(), times_insert.end(), 0.0) / NUM_ITERATIONS;
+    double avg_search = accumulate(times_search.begin(), times_search.end(), 0.0) / NUM_ITERATIONS;
+    double avg_search_batch = accumulate(times_search_batch.begin(), times_search_batch.end(), 0.0) / NUM_ITERATIONS;
+    double avg_erase = accumulate(times_erase.begin(), times_erase.end(), 0.0) / NUM_ITERATIONS;
+
+    csv << N << "," << structure << ",insert," << avg_insert << "\n";
+    csv << N << "," << structure << ",search," << avg_search << "\n";
+    csv << N << "," << structure << ",search_batch," << avg_search_batch << "\n";
+    csv << N << "," << structure << ",erase," << avg_erase << "\n";
+
+    cout << label << " → insert:" << avg_insert
+         << " search:" << avg_search
+         << " search_batch:" << avg_search_batch
+         << " erase:" << avg_erase << " µs\n";
+}
+
+// Benchmark de inserción, búsqueda y eliminación para un BTree (misma interfaz que AVL)
+template<typename Tree>
+void benchmark_btree(const string& structure, const string& label, int N, int NUM_ITERATIONS,
+                     ofstream& csv, mt19937& rng, uniform_int_distribution<int>& dist) {
+    vector<double> times_insert, times_search, times_erase;
+
+    for (int iter = 0; iter < NUM_ITERATIONS; ++iter) {
+        vector<int> data;
+        data.reserve(N);
+        for (int i = 0; i < N; ++i) data.push_back(dist(rng));
+
+        Tree bt;
+        auto start = high_resolution_clock::now();
+        for (int v : data) bt.insert(v);
+        auto end = high_resolution_clock::now();
+        times_insert.push_back(duration_cast<duration<double, micro>>(end - start).count());
+
+        volatile int dummy = 0;
+        start = high_resolution_clock::now();
+        for (int v : data) dummy = dummy + (bt.find(v) ? 1 : 0);
+        end = high_resolution_clock::now();
+        times_search.push_back(duration_cast<duration<double, micro>>(end - start).count());
+
+        start = high_resolution_clock::now();
+        for (int v : data) bt.remove(v);
+        end = high_resolution_clock::now();
+        times_erase.push_back(duration_cast<duration<double, micro>>(end - start).count());
+    }
+
+    double avg_insert = accumulate(times_insert.begin(), times_insert.end(), 0.0) / NUM_ITERATIONS;
+    double avg_search = accumulate(times_search.begin(), times_search.end(), 0.0) / NUM_ITERATIONS;
+    double avg_erase = accumulate(times_erase.begin(), times_erase.end(), 0.0) / NUM_ITERATIONS;
+
+    csv << N << "," << structure << ",insert," << avg_insert << "\n";
+    csv << N << "," << structure << ",search," << avg_search << "\n";
+    csv << N << "," << structure << ",erase," << avg_erase << "\n";
+
+    cout << label << " → insert:" << avg_insert
+         << " search:" << avg_search
+         << " erase:" << avg_erase << " µs\n";
+}
+
+// Índice congelado (freeze) de un RB_tree: coste de construirlo y búsqueda sobre él.
+// Las mismas claves y búsquedas que benchmark_rb_tree, para comparar con su "search".
+template<typename Index>
+void benchmark_frozen_index(const string& structure, const string& label, int N, int NUM_ITERATIONS,
+                            ofstream& csv, mt19937& rng, uniform_int_distribution<int>& dist) {
+    vector<double> times_freeze, times_search;
+
+    for (int iter = 0; iter < NUM_ITERATIONS; ++iter) {
+        vector<int> data;
+        data.reserve(N);
+        for (int i = 0; i < N; ++i) data.push_back(dist(rng));
+
+        RB_tree<int> rb;
+        for (int v : data) rb.add_leaf(v);
+
+        auto start = high_resolution_clock::now();
+        Index index = rb.freeze<Index>();
+        auto end = high_resolution_clock::now();
+        times_freeze.push_back(duration_cast<duration<double, micro>>(end - start).count());
+
+        volatile int dummy = 0;
+        start = high_resolution_clock::now();
+        for (int v : data) dummy = dummy + (index.find(v) ? 1 : 0);
+        end = high_resolution_clock::now();
+        times_search.push_back(duration_cast<duration<double, micro>>(end - start).count());
+    }
+
+    double avg_freeze = accumulate(times_freeze.begin(), times_freeze.end(), 0.0) / NUM_ITERATIONS;
+    double avg_search = accumulate(times_search.begin(), times_search.end(), 0.0) / NUM_ITERATIONS;
+
+    csv << N << "," << structure << ",freeze," << avg_freeze << "\n";
+    csv << N << "," << structure << ",search," << avg_search << "\n";
+
+    cout << label << " → freeze:" << avg_freeze
+         << " search:" << avg_search << " µs\n";
+}
+
+// Efecto del layout de nodo sobre la memoria y sobre find (una iteración por N)
+template<typename Tree>
+void benchmark_rb_layout(const string& structure, int N, const vector<int>& data,
+                         ofstream& csv, ofstream& memory_csv) {
+    Tree rb;
+    for (int v : data) rb.add_leaf(v);
+
+    volatile int dummy = 0;
+    auto start = high_resolution_clock::now();
+    for (int v : data) dummy = dummy + (rb.find(v) ? 1 : 0);
+    auto end = high_resolution_clock::now();
+    double t_search = duration_cast<duration<double, micro>>(end - start).count();
+
+    csv << N << "," << structure << ",search," << t_search << "\n";
+    memory_csv << N << "," << structure << "," << Tree::node_bytes << "," << rb.reserved_bytes() << "\n";
+
+    cout << structure << " → nodo:" << Tree::node_bytes << " B"
+         << " reservado:" << rb.reserved_bytes() / (1024.0 * 1024.0) << " MiB"
+         << " search:" << t_search << " µs\n";
+}
+
+// AVL con altura por nodo frente a CompactAVL (balance de 2 bits en el puntero
+// izquierdo): inserción, búsqueda y borrado, bytes por nodo y memoria reservada
+template<typename Tree>
+void benchmark_avl_layout(const string& structure, int N, const vector<int>& data,
+                          ofstream& csv, ofstream& memory_csv) {
+    Tree avl;
+    auto start = high_resolution_clock::now();
+    for (int v : data) avl.insert(v);
+    auto end = high_resolution_clock::now();
+    double t_insert = duration_cast<duration<double, micro>>(end - start).count();
+    size_t reserved = avl.reserved_bytes();
+
+    volatile int dummy = 0;
+    start = high_resolution_clock::now();
+    for (int v : data) dummy = dummy + (avl.find(v) ? 1 : 0);
+    end = high_resolution_clock::now();
+    double t_search = duration_cast<duration<double, micro>>(end - start).count();
+
+    start = high_resolution_clock::now();
+    for (int v : data) avl.remove(v);
+    end = high_resolution_clock::now();
+    double t_erase = duration_cast<duration<double, micro>>(end - start).count();
+
+    csv << N << "," << structure << ",insert," << t_insert << "\n";
+    csv << N << "," << structure << ",search," << t_search << "\n";
+    csv << N << "," << structure << ",erase," << t_erase << "\n";
+    memory_csv << N << "," << structure << "," << Tree::node_bytes << "," << reserved << "\n";
+
+    cout << structure << " → nodo:" << Tree::node_bytes << " B"
+         << " reservado:" << reserved / (1024.0 * 1024.0) << " MiB"
+         << " insert:" << t_insert
+         << " search:" << t_search
+         << " erase:" << t_erase << " µs\n";
+}
+
+// Carga masiva (assign) frente al bucle de add_leaf, con entrada ordenada y desordenada
+void benchmark_rb_bulk_load(int N, const vector<int>& data, ofstream& csv) {
+    vector<int> sorted_data(data);
+    sort(sorted_data.begin(), sorted_data.end());
+
+    auto time_build = [&](const string& operation, auto&& build) {
+        RB_tree<int> rb;
+        auto start = high_resolution_clock::now();
+        build(rb);
+        auto end = high_resolution_clock::now();
+        double t = duration_cast<duration<double, micro>>(end - start).count();
+        csv << N << ",RedBlackTree," << operation << "," << t << "\n";
+        cout << "  " << operation << ": " << t << " µs\n";
+    };
+
+    time_build("build_add_leaf_random", [&](RB_tree<int>& rb) { for (int v : data) rb.add_leaf(v); });
+    time_build("build_assign_random", [&](RB_tree<int>& rb) { rb.assign(data.begin(), data.end()); });
+#ifdef RB_TREE_PARALLEL_SORT
+    time_build("build_assign_random_par", [&](RB_tree<int>& rb) { rb.assign(data.begin(), data.end(), true); });
+#endif
+    time_build("build_add_leaf_sorted", [&](RB_tree<int>& rb) { for (int v : sorted_data) rb.add_leaf(v); });
+    time_build("build_assign_sorted", [&](RB_tree<int>& rb) { rb.assign(sorted_data.begin(), sorted_data.end()); });
+}
+
+// Arranque desde un snapshot: reinsertar cada clave con add_leaf frente a load()
+// del archivo escrito por save(), con y sin la forma guardada.
+// El archivo recién escrito está en la caché de páginas: mide la reconstrucción, no el disco.
+void benchmark_rb_snapshot(int N, const vector<int>& data, ofstream& csv) {
+    const string path = "rb_snapshot.bin";
+    RB_tree<int> source;
+    source.assign(data.begin(), data.end());
+
+    auto start = high_resolution_clock::now();
+    {
+        RB_tree<int> rb;
+        for (int v : data) rb.add_leaf(v);
+    }
+    auto end = high_resolution_clock::now();
+    double t_reinsert = duration_cast<duration<double, micro>>(end - start).count();
+
+    start = high_resolution_clock::now();
+    source.save(path);
+    end = high_resolution_clock::now();
+    double t_save = duration_cast<duration<double, micro>>(end - start).count();
+
+    start = high_resolution_clock::now();
+    {
+        RB_tree<int> rb;
+        rb.load(path);
+    }
+    end = high_resolution_clock::now();
+    double t_load = duration_cast<duration<double, micro>>(end - start).count();
+
+    source.save(path, true);
+    start = high_resolution_clock::now();
+    {
+        RB_tree<int> rb;
+        rb.load(path);
+    }
+    end = high_resolution_clock::now();
+    double t_load_shape = duration_cast<duration<double, micro>>(end - start).count();
+    remove(path.c_str());
+
+    csv << N << ",RedBlackTree,reinsert," << t_reinsert << "\n";
+    csv << N << ",RedBlackTree,save," << t_save << "\n";
+    csv << N << ",RedBlackTree,load_mmap," << t_load << "\n";
+    csv << N << ",RedBlackTree,load_mmap_shape," << t_load_shape << "\n";
+
+    cout << "Red-Black Tree → reinsert:" << t_reinsert
+         << " save:" << t_save
+         << " load_mmap:" << t_load
+         << " load_mmap_shape:" << t_load_shape << " µs\n";
+}
+
+// Árbol dentro de un archivo proyectado frente al RB_tree en el heap: construirlo,
+// tenerlo listo al arrancar (reinsertar o cargar el snapshot frente a abrir el
+// archivo) y buscar en él
+void benchmark_rb_mapped(int N, const vector<int>& data, ofstream& csv) {
+    const string path = "rb_mapped.bin";
+    const string snapshot = "rb_snapshot.bin";
+    remove(path.c_str());
+
+    auto start = high_resolution_clock::now();
+    {
+        MappedRBTree<int> mapped(path);
+        for (int v : data) mapped.add_leaf(v);
+    }
+    auto end = high_resolution_clock::now();
+    double t_mapped_insert = duration_cast<duration<double, micro>>(end - start).count();
+
+    RB_tree<int> heap;
+    start = high_resolution_clock::now();
+    for (int v : data) heap.add_leaf(v);
+    end = high_resolution_clock::now();
+    double t_heap_insert = duration_cast<duration<double, micro>>(end - start).count();
+    heap.save(snapshot);
+
+    start = high_resolution_clock::now();
+    RB_tree<int> loaded;
+    loaded.load(snapshot);
+    end = high_resolution_clock::now();
+    double t_heap_load = duration_cast<duration<double, micro>>(end - start).count();
+
+    start = high_resolution_clock::now();
+    MappedRBTree<int> mapped(path, true);
+    end = high_resolution_clock::now();
+    double t_mapped_open = duration_cast<duration<double, micro>>(end - start).count();
+
+    // La primera pasada por el árbol proyectado incluye los fallos de página
+    // (el archivo ya está en la caché del sistema: no hay lecturas de disco)
+    volatile int dummy = 0;
+    start = high_resolution_clock::now();
+    for (int v : data) dummy = dummy + (mapped.find(v) ? 1 : 0);
+    end = high_resolution_clock::now();
+    double t_mapped_search = duration_cast<duration<double, micro>>(end - start).count();
+
+    start = high_resolution_clock::now();
+    for (int v : data) dummy = dummy + (loaded.find(v) ? 1 : 0);
+    end = high_resolution_clock::now();
+    double t_heap_search = duration_cast<duration<double, micro>>(end - start).count();
+
+    // Mismo layout de índices de 32 bits que el árbol proyectado, pero en el heap:
+    // separa el coste del layout del de la proyección
+    RB_index_tree<int> index_tree;
+    for (int v : data) index_tree.add_leaf(v);
+    start = high_resolution_clock::now();
+    for (int v : data) dummy = dummy + (index_tree.find(v) ? 1 : 0);
+    end = high_resolution_clock::now();
+    double t_index_search = duration_cast<duration<double, micro>>(end - start).count();
+
+    remove(snapshot.c_str());
+
+    csv << N << ",RedBlackTree,insert," << t_heap_insert << "\n";
+    csv << N << ",RedBlackTree,startup_load," << t_heap_load << "\n";
+    csv << N << ",RedBlackTree,search," << t_heap_search << "\n";
+    csv << N << ",RedBlackTree_index32,search," << t_index_search << "\n";
+    csv << N << ",RedBlackTree_mapped,insert," << t_mapped_insert << "\n";
+    csv << N << ",RedBlackTree_mapped,startup_open," << t_mapped_open << "\n";
+    csv << N << ",RedBlackTree_mapped,search," << t_mapped_search << "\n";
+
+    cout << "Red-Black Tree (heap) → insert:" << t_heap_insert
+         << " startup_load:" << t_heap_load
+         << " search:" << t_heap_search
+         << " search (index32):" << t_index_search << " µs\n";
+    cout << "Red-Black Tree (mmap) → insert:" << t_mapped_insert
+         << " startup_open:" << t_mapped_open
+         << " search:" << t_mapped_search
+         << " (" << mapped.file_bytes() / (1024 * 1024) << " MiB) µs\n";
+}
+
+// Mismas operaciones con la política tree_stats: cada fila de stats_results.csv
+// pone el tiempo de una operación junto al trabajo estructural que hizo
+// (rotaciones, casos de fixup, longitud de los descensos, profundidad de los splays)
+template<typename Tree, typename Insert, typename Find, typename Erase>
+void benchmark_tree_stats(int N, const string& structure, const vector<int>& data, ofstream& stats_csv,
+                          Insert insert, Find find, Erase erase) {
+    Tree tree;
+    auto run = [&](const string& op, auto&& f) {
+        tree.reset_stats();
+        auto start = high_resolution_clock::now();
+        for (int v : data) f(tree, v);
+        auto end = high_resolution_clock::now();
+        double t = duration_cast<duration<double, micro>>(end - start).count();
+
+        const tree_stats& st = tree.stats();
+        stats_csv << N << "," << structure << "," << op << "," << t << ",";
+        st.write_csv(stats_csv);
+        stats_csv << "\n";
+        cout << structure << " " << op << " → " << t << " µs, rotaciones:" << st.rotations
+             << " descenso medio:" << st.search.mean() << " (máx " << st.search.max << ")";
+        if (st.fixup.samples != 0) cout << " fixup medio:" << st.fixup.mean() << " (máx " << st.fixup.max << ")";
+        if (st.splay.samples != 0) cout << " splay medio:" << st.splay.mean() << " (máx " << st.splay.max << ")";
+        cout << "\n";
+    };
+    run("insert", insert);
+    run("search", find);
+    run("erase", erase);
+}
+
+// Coste del aumento de tamaños de subárbol y de rank/select sobre RB_order_tree
+void benchmark_rb_order_statistics(int N, const vector<int>& data, ofstream& csv) {
+    RB_order_tree<int> rb;
+    auto start = high_resolution_clock::now();
+    for (int v : data) rb.add_leaf(v);
+    auto end = high_resolution_clock::now();
+    double t_insert = duration_cast<duration<double, micro>>(end - start).count();
+
+    volatile size_t dummy = 0;
+    start = high_resolution_clock::now();
+    for (int v : data) dummy = dummy + rb.rank(v);
+    end = high_resolution_clock::now();
+    double t_rank = duration_cast<duration<double, micro>>(end - start).count();
+
+    start = high_resolution_clock::now();
+    for (int k = 0; k < N; ++k) dummy = dummy + rb.select(k);
+    end = high_resolution_clock::now();
+    double t_select = duration_cast<duration<double, micro>>(end - start).count();
+
+    start = high_resolution_clock::now();
+    for (int v : data) rb.delete_leaf(v);
+    end = high_resolution_clock::now();
+    double t_erase = duration_cast<duration<double, micro>>(end - start).count();
+
+    csv << N << ",RedBlackTree_order,insert," << t_insert << "\n";
+    csv << N << ",RedBlackTree_order,rank," << t_rank << "\n";
+    csv << N << ",RedBlackTree_order,select," << t_select << "\n";
+    csv << N << ",RedBlackTree_order,erase," << t_erase << "\n";
+
+    cout << "Red-Black Tree (order statistics) → insert:" << t_insert
+         << " rank:" << t_rank
+         << " select:" << t_select
+         << " erase:" << t_erase << " µs\n";
+}
+
+// Consultas "intervalos que cortan [a, b]": RB_interval_tree frente a recorrer todos
+void benchmark_rb_intervals(int N, mt19937& rng, ofstream& csv) {
+    // Inicios en [0, 1e9) y longitudes hasta 1e4: cada consulta corta unos pocos cientos
+    uniform_int_distribution<int> start_dist(0, 1000000000), length_dist(0, 10000);
+    vector<pair<int, int>> intervals;
+    intervals.reserve(N);
+    for (int i = 0; i < N; ++i) {
+        int a = start_dist(rng);
+        intervals.emplace_back(a, a + length_dist(rng));
+    }
+    const int Q = 1000;
+    vector<pair<int, int>> queries;
+    queries.reserve(Q);
+    for (int i = 0; i < Q; ++i) {
+        int a = start_dist(rng);
+        queries.emplace_back(a, a + 100000);
+    }
+
+    RB_interval_tree<int> tree;
+    auto start = high_resolution_clock::now();
+    for (const auto& iv : intervals) tree.add_leaf(iv);
+    auto end = high_resolution_clock::now();
+    double t_insert = duration_cast<duration<double, micro>>(end - start).count();
+
+    volatile long long dummy = 0;
+    size_t found_tree = 0;
+    start = high_resolution_clock::now();
+    for (const auto& [a, b] : queries)
+        found_tree += tree.overlapping(a, b, [&](const pair<int, int>& iv) { dummy = dummy + iv.first; });
+    end = high_resolution_clock::now();
+    double t_tree = duration_cast<duration<double, micro>>(end - start).count();
+
+    size_t found_scan = 0;
+    start = high_resolution_clock::now();
+    for (const auto& [a, b] : queries) {
+        for (const auto& iv : intervals) {
+            if (iv.second >= a && iv.first <= b) {
+                dummy = dummy + iv.first;
+                ++found_scan;
+            }
+        }
+    }
+    end = high_resolution_clock::now();
+    double t_scan = duration_cast<duration<double, micro>>(end - start).count();
+    if (found_tree != found_scan) cerr << "RB_interval_tree: resultados distintos del recorrido completo\n";
+
+    csv << N << ",RedBlackTree_interval,insert," << t_insert << "\n";
+    csv << N << ",RedBlackTree_interval,overlap_query," << t_tree << "\n";
+    csv << N << ",LinearScan,overlap_query," << t_scan << "\n";
+
+    cout << "Intervalos (" << Q << " consultas, " << found_tree / Q << " resultados de media) → insert:" << t_insert
+         << " árbol:" << t_tree
+         << " recorrido completo:" << t_scan << " µs\n";
+}
+
+// Sumas por rango de claves: aggregate(lo, hi) frente a recorrer el rango
+// con iteradores o encadenando sucesor(key)
+void benchmark_rb_aggregate(int N, mt19937& rng, ofstream& csv) {
+    uniform_int_distribution<int> key_dist(0, 1000000000), value_dist(0, 1000);
+    RB_aggregate_tree<int, long long> tree;
+    vector<pair<int, long long>> items;
+    items.reserve(N);
+    for (int i = 0; i < N; ++i) items.emplace_back(key_dist(rng), value_dist(rng));
+
+    auto start = high_resolution_clock::now();
+    for (const auto& kv : items) tree.insert_unique(kv);
+    auto end = high_resolution_clock::now();
+    double t_insert = duration_cast<duration<double, micro>>(end - start).count();
+
+    // Rangos del 0.1% del espacio de claves: unas N / 1000 claves por consulta
+    const int Q = 1000;
+    vector<pair<int, int>> queries;
+    queries.reserve(Q);
+    for (int i = 0; i < Q; ++i) {
+        int lo = key_dist(rng);
+        queries.emplace_back(lo, lo + 1000000);
+    }
+
+    volatile long long dummy = 0;
+    long long sum_aggregate = 0;
+    start = high_resolution_clock::now();
+    for (const auto& [lo, hi] : queries) sum_aggregate += tree.aggregate(lo, hi);
+    end = high_resolution_clock::now();
+    double t_aggregate = duration_cast<duration<double, micro>>(end - start).count();
+
+    long long sum_iterator = 0;
+    start = high_resolution_clock::now();
+    for (const auto& [lo, hi] : queries)
+        for (auto it = tree.lower_bound(lo); it != tree.end() && it->first <= hi; ++it) sum_iterator += it->second;
+    end = high_resolution_clock::now();
+    double t_iterator = duration_cast<duration<double, micro>>(end - start).count();
+
+    long long sum_sucesor = 0;
+    start = high_resolution_clock::now();
+    for (const auto& [lo, hi] : queries) {
+        auto it = tree.lower_bound(lo);
+        if (it == tree.end()) continue;
+        pair<int, long long> kv = *it;
+        try {
+            while (kv.first <= hi) {
+                sum_sucesor += kv.second;
+                kv = tree.sucesor(kv);
+            }
+        } catch (const runtime_error&) {
+            // el máximo no tiene sucesor
+        }
+    }
+    end = high_resolution_clock::now();
+    double t_sucesor = duration_cast<duration<double, micro>>(end - start).count();
+    dummy = dummy + sum_aggregate;
+    if (sum_aggregate != sum_iterator || sum_aggregate != sum_sucesor)
+        cerr << "RB_aggregate_tree: sumas distintas del recorrido del rango\n";
+
+    csv << N << ",RedBlackTree_aggregate,insert," << t_insert << "\n";
+    csv << N << ",RedBlackTree_aggregate,range_sum," << t_aggregate << "\n";
+    csv << N << ",RedBlackTree_aggregate,range_sum_iterator," << t_iterator << "\n";
+    csv << N << ",RedBlackTree_aggregate,range_sum_sucesor," << t_sucesor << "\n";
+
+    cout << "Agregados (" << Q << " sumas por rango) → insert:" << t_insert
+         << " aggregate:" << t_aggregate
+         << " iteradores:" << t_iterator
+         << " sucesor:" << t_sucesor << " µs\n";
+}
+
+// Caducidad de claves antiguas (series temporales): en 100 tandas se borra la mitad
+// más antigua de las claves con delete_leaf clave a clave, con erase(iterador) desde
+// begin() y con erase_range
+void benchmark_rb_range_erase(int N, vector<int> data, ofstream& csv) {
+    // Claves únicas, como las marcas de tiempo: cada tanda es exactamente data[from, to)
+    sort(data.begin(), data.end());
+    data.erase(unique(data.begin(), data.end()), data.end());
+    const int batches = 100;
+    const size_t per_batch = data.size() / 2 / batches;
+
+    auto timed = [&](auto&& expire) {
+        RB_tree<int> rb(data.begin(), data.end());
+        auto start = high_resolution_clock::now();
+        for (int b = 0; b < batches; ++b) expire(rb, b * per_batch, (b + 1) * per_batch);
+        auto end = high_resolution_clock::now();
+        if (rb.size() != data.size() - batches * per_batch) cerr << "erase_range: tamaño inesperado\n";
+        return duration_cast<duration<double, micro>>(end - start).count();
+    };
+    double t_delete = timed([&](RB_tree<int>& rb, size_t from, size_t to) {
+        for (size_t i = from; i < to; ++i) rb.delete_leaf(data[i]);
+    });
+    double t_iterator = timed([&](RB_tree<int>& rb, size_t from, size_t to) {
+        for (auto it = rb.begin(); from < to; ++from) it = rb.erase(it);
+    });
+    double t_range = timed([&](RB_tree<int>& rb, size_t from, size_t to) {
+        rb.erase_range(data[from], data[to - 1]);
+    });
+
+    csv << N << ",RedBlackTree,expire_delete_leaf," << t_delete << "\n";
+    csv << N << ",RedBlackTree,expire_erase_iterator," << t_iterator << "\n";
+    csv << N << ",RedBlackTree,expire_erase_range," << t_range << "\n";
+
+    cout << "Caducidad (" << batches << " tandas, " << batches * per_batch << " claves) → delete_leaf:" << t_delete
+         << " erase(iterador):" << t_iterator
+         << " erase_range:" << t_range << " µs\n";
+}
+
+// Claves que llegan en orden (marcas de tiempo): estrictamente crecientes y casi
+// ordenadas (un 5% llega con hasta 64 posiciones de retraso). Mide el camino rápido
+// por el máximo cacheado de add_leaf y de AVL::insert, e insert_hint(end()).
+void benchmark_near_sorted(int N, mt19937& rng, ofstream& csv) {
+    vector<int> sorted_keys(N);
+    for (int i = 0; i < N; ++i) sorted_keys[i] = i * 10;
+    vector<int> near_sorted = sorted_keys;
+    for (int i = 0; i + 64 < N; ++i)
+        if (rng() % 20 == 0) swap(near_sorted[i], near_sorted[i + rng() % 64]);
+
+    auto timed = [](auto&& insert_all) {
+        auto start = high_resolution_clock::now();
+        insert_all();
+        auto end = high_resolution_clock::now();
+        return duration_cast<duration<double, micro>>(end - start).count();
+    };
+    for (const auto& [workload, keys] : {pair<const char*, const vector<int>*>{"insert_sorted", &sorted_keys},
+                                         pair<const char*, const vector<int>*>{"insert_near_sorted", &near_sorted}}) {
+        RB_tree<int> rb;
+        double t_rb = timed([&] { for (int k : *keys) rb.add_leaf(k); });
+        RB_tree<int> rb_hint;
+        double t_rb_hint = timed([&] { for (int k : *keys) rb_hint.insert_hint(rb_hint.end(), k); });
+        AVL<int> avl;
+        double t_avl = timed([&] { for (int k : *keys) avl.insert(k); });
+        set<int> s;
+        double t_set = timed([&] { for (int k : *keys) s.insert(k); });
+        set<int> s_hint;
+        double t_set_hint = timed([&] { for (int k : *keys) s_hint.emplace_hint(s_hint.end(), k); });
+
+        csv << N << ",RedBlackTree," << workload << "," << t_rb << "\n";
+        csv << N << ",RedBlackTree_hint," << workload << "," << t_rb_hint << "\n";
+        csv << N << ",AVL," << workload << "," << t_avl << "\n";
+        csv << N << ",std::set," << workload << "," << t_set << "\n";
+        csv << N << ",std::set_hint," << workload << "," << t_set_hint << "\n";
+
+        cout << workload << " → RB add_leaf:" << t_rb
+             << " RB insert_hint:" << t_rb_hint
+             << " AVL:" << t_avl
+             << " std::set:" << t_set
+             << " std::set hint:" << t_set_hint << " µs\n";
+    }
+}
+
+// Localidad tras mucho churn: N altas y N bajas aleatorias dejan los nodos repartidos
+// por los huecos del pool. Se mide find sobre el árbol así, tras compact() en preorden
+// y en orden de van Emde Boas, y tras la compactación incremental en pasos de 1024
+// nodos (con el paso más largo, que es la pausa que vería quien la intercala).
+void benchmark_rb_compaction(int N, mt19937& rng, ofstream& csv) {
+    uniform_int_distribution<int> dist(1, N * 10);
+    vector<int> keys(N);
+    for (int& k : keys) k = dist(rng);
+    vector<int> queries(N);
+    for (int& q : queries) q = keys[rng() % N];
+    auto churned = [&] {
+        RB_tree<int> rb;
+        for (int k : keys) rb.add_leaf(k);
+        mt19937 churn(N);
+        for (int i = 0; i < N; ++i) {
+            int victim = keys[churn() % N];
+            rb.delete_leaf(victim);
+            rb.add_leaf(victim);
+        }
+        return rb;
+    };
+    auto timed = [](auto&& f) {
+        auto start = high_resolution_clock::now();
+        f();
+        auto end = high_resolution_clock::now();
+        return duration_cast<duration<double, micro>>(end - start).count();
+    };
+    auto search = [&](const RB_tree<int>& rb) {
+        return timed([&] {
+            for (int q : queries) {
+                volatile bool dummy = rb.find(q);
+                (void)dummy;
+            }
+        });
+    };
+
+    RB_tree<int> rb = churned();
+    double t_churned = search(rb);
+    double t_compact_dfs = timed([&] { rb.compact(rb_node_order::preorder); });
+    double t_search_dfs = search(rb);
+    double t_compact_veb = timed([&] { rb.compact(rb_node_order::van_emde_boas); });
+    double t_search_veb = search(rb);
+
+    RB_tree<int> inc = churned();
+    double t_incremental = 0, t_max_step = 0;
+    for (bool done = false; !done;) {
+        double t = timed([&] { done = inc.compact_step(1024); });
+        t_incremental += t;
+        t_max_step = max(t_max_step, t);
+    }
+    double t_search_inc = search(inc);
+
+    csv << N << ",RedBlackTree,search_churned," << t_churned << "\n";
+    csv << N << ",RedBlackTree,compact_dfs," << t_compact_dfs << "\n";
+    csv << N << ",RedBlackTree,search_compact_dfs," << t_search_dfs << "\n";
+    csv << N << ",RedBlackTree,compact_veb," << t_compact_veb << "\n";
+    csv << N << ",RedBlackTree,search_compact_veb," << t_search_veb << "\n";
+    csv << N << ",RedBlackTree,compact_incremental," << t_incremental << "\n";
+    csv << N << ",RedBlackTree,compact_step_max," << t_max_step << "\n";
+    csv << N << ",RedBlackTree,search_compact_incremental," << t_search_inc << "\n";
+
+    cout << "find → churn:" << t_churned
+         << " preorden:" << t_search_dfs
+         << " vEB:" << t_search_veb
+         << " incremental:" << t_search_inc << " µs\n";
+    cout << "compact → preorden:" << t_compact_dfs
+         << " vEB:" << t_compact_veb
+         << " incremental:" << t_incremental << " (paso máx. " << t_max_step << ") µs\n";
+}
+
+// AVL: inserción y borrado iterativos (pila de enlaces, la subida se corta en cuanto
+// las alturas dejan de cambiar) frente a los recursivos originales, y destrucción del
+// árbol con slab_pool (se sueltan los slabs) frente a heap_pool (un delete por nodo)
+void benchmark_avl_iterative(int N, const vector<int>& data, ofstream& csv) {
+    auto timed = [](auto&& f) {
+        auto start = high_resolution_clock::now();
+        f();
+        auto end = high_resolution_clock::now();
+        return duration_cast<duration<double, micro>>(end - start).count();
+    };
+    AVL<int> recursive;
+    double t_insert_rec = timed([&] { for (int v : data) recursive.insert_recursive(v); });
+    double t_erase_rec = timed([&] { for (int v : data) recursive.remove_recursive(v); });
+    AVL<int> iterative;
+    double t_insert_it = timed([&] { for (int v : data) iterative.insert(v); });
+    double t_erase_it = timed([&] { for (int v : data) iterative.remove(v); });
+
+    auto* slab = new AVL<int>();
+    auto* heap = new AVL<int, less<int>, heap_pool>();
+    for (int v : data) {
+        slab->insert(v);
+        heap->insert(v);
+    }
+    double t_destroy_slab = timed([&] { delete slab; });
+    double t_destroy_heap = timed([&] { delete heap; });
+
+    csv << N << ",AVL_recursive,insert," << t_insert_rec << "\n";
+    csv << N << ",AVL_recursive,erase," << t_erase_rec << "\n";
+    csv << N << ",AVL_iterative,insert," << t_insert_it << "\n";
+    csv << N << ",AVL_iterative,erase," << t_erase_it << "\n";
+    csv << N << ",AVL,destroy," << t_destroy_slab << "\n";
+    csv << N << ",AVL_heap_pool,destroy," << t_destroy_heap << "\n";
+
+    cout << "AVL recursivo → insert:" << t_insert_rec << " erase:" << t_erase_rec << " µs\n";
+    cout << "AVL iterativo → insert:" << t_insert_it << " erase:" << t_erase_it << " µs\n";
+    cout << "Destrucción → slab_pool:" << t_destroy_slab << " heap_pool:" << t_destroy_heap << " µs\n";
+}
+
+// Splay: la interfaz virtual splay_tree (llamadas por puntero a la base) frente a
+// SplayTree<int> llamado directamente, que se inlinea en el bucle. Con una sola
+// implementación a la vista, GCC -O2 ya especula el tipo dinámico (compara el vptr e
+// inlinea, con la llamada indirecta de respaldo), así que la diferencia es pequeña;
+// SplayTree con heap_pool (un new/delete por nodo, como el malloc/free de antes)
+// muestra lo que aporta el slab_pool. El último caso usa claves de 64 bits.
+void benchmark_splay_dispatch(int N, const vector<int>& data, ofstream& csv) {
+    auto run = [&](const string& structure, auto& tree, auto key) {
+        auto start = high_resolution_clock::now();
+        for (int v : data) tree.insert(key(v));
+        auto end = high_resolution_clock::now();
+        double t_insert = duration_cast<duration<double, micro>>(end - start).count();
+
+        volatile int dummy = 0;
+        start = high_resolution_clock::now();
+        for (int v : data) dummy = dummy + (tree.find(key(v)) ? 1 : 0);
+        end = high_resolution_clock::now();
+        double t_search = duration_cast<duration<double, micro>>(end - start).count();
+
+        start = high_resolution_clock::now();
+        for (int v : data) tree.remove(key(v));
+        end = high_resolution_clock::now();
+        double t_erase = duration_cast<duration<double, micro>>(end - start).count();
+
+        csv << N << "," << structure << ",insert," << t_insert << "\n";
+        csv << N << "," << structure << ",search," << t_search << "\n";
+        csv << N << "," << structure << ",erase," << t_erase << "\n";
+        cout << structure << " → insert:" << t_insert
+             << " search:" << t_search
+             << " erase:" << t_erase << " µs\n";
+    };
+    auto same = [](int v) { return v; };
+
+    unique_ptr<splay_tree> virtual_splay = make_unique<splay_tree_implementation>();
+    run("Splay_virtual", *virtual_splay, same);
+    SplayTree<int, less<int>, heap_pool> heap_splay;
+    run("SplayTree_heap", heap_splay, same);
+    SplayTree<int> splay;
+    run("SplayTree", splay, same);
+    SplayTree<int64_t> wide_splay;
+    run("SplayTree_int64", wide_splay, [](int v) { return int64_t(v) << 20; });
+}
+
+// Recorrido ordenado completo: iteradores frente a encadenar sucesor(key)
+void benchmark_rb_range_scan(int N, vector<int> data, ofstream& csv) {
+    // sucesor(key) necesita claves únicas para avanzar
+    sort(data.begin(), data.end());
+    data.erase(unique(data.begin(), data.end()), data.end());
+    RB_tree<int> rb(data.begin(), data.end());
+
+    volatile long long dummy = 0;
+    auto start = high_resolution_clock::now();
+    for (int k : rb) dummy = dummy + k;
+    auto end = high_resolution_clock::now();
+    double t_iter = duration_cast<duration<double, micro>>(end - start).count();
+
+    start = high_resolution_clock::now();
+    try {
+        int k = *rb.begin();
+        while (true) {
+            dummy = dummy + k;
+            k = rb.sucesor(k);
+        }
+    } catch (const runtime_error&) {
+        // fin del recorrido: el máximo no tiene sucesor
+    }
+    end = high_resolution_clock::now();
+    double t_sucesor = duration_cast<duration<double, micro>>(end - start).count();
+
+    csv << N << ",RedBlackTree,scan_iterator," << t_iter << "\n";
+    csv << N << ",RedBlackTree,scan_sucesor," << t_sucesor << "\n";
+
+    cout << "Red-Black Tree recorrido → iteradores:" << t_iter
+         << " sucesor(key):" << t_sucesor << " µs\n";
+}
+
+// Semántica de conjunto: find + add_leaf (dos descensos) frente a insert_unique (uno)
+template<typename K>
+void benchmark_rb_insert_unique(int N, const string& key_type, const vector<K>& data, ofstream& csv) {
+    RB_tree<K> rb_two_pass;
+    auto start = high_resolution_clock::now();
+    for (const K& v : data)
+        if (!rb_two_pass.find(v)) rb_two_pass.add_leaf(v);
+    auto end = high_resolution_clock::now();
+    double t_two_pass = duration_cast<duration<double, micro>>(end - start).count();
+
+    RB_tree<K> rb_unique;
+    start = high_resolution_clock::now();
+    for (const K& v : data) rb_unique.insert_unique(v);
+    end = high_resolution_clock::now();
+    double t_unique = duration_cast<duration<double, micro>>(end - start).count();
+
+    csv << N << ",RedBlackTree_" << key_type << ",find_then_add_leaf," << t_two_pass << "\n";
+    csv << N << ",RedBlackTree_" << key_type << ",insert_unique," << t_unique << "\n";
+
+    cout << "Red-Black Tree<" << key_type << "> conjunto → find+add_leaf:" << t_two_pass
+         << " insert_unique:" << t_unique << " µs\n";
+}
+
+// Mismo orden que std::less<string>, pero sin la vía rápida de tres vías:
+// cada nivel de búsqueda hace dos comparaciones de cadenas
+struct string_less_two_way {
+    bool operator()(const string& a, const string& b) const { return a < b; }
+};
+
+// Claves std::string: comparación de tres vías (std::less) frente a dos comparaciones por nivel
+template<typename Tree>
+void benchmark_string_keys(int N, const string& structure, const vector<string>& data,
+                           ofstream& csv, auto&& insert) {
+    Tree tree;
+    auto start = high_resolution_clock::now();
+    for (const string& v : data) insert(tree, v);
+    auto end = high_resolution_clock::now();
+    double t_insert = duration_cast<duration<double, micro>>(end - start).count();
+
+    volatile int dummy = 0;
+    start = high_resolution_clock::now();
+    for (const string& v : data) dummy = dummy + (tree.find(v) ? 1 : 0);
+    end = high_resolution_clock::now();
+    double t_search = duration_cast<duration<double, micro>>(end - start).count();
+
+    csv << N << "," << structure << ",insert," << t_insert << "\n";
+    csv << N << "," << structure << ",search," << t_search << "\n";
+
+    cout << structure << " → insert:" << t_insert << " search:" << t_search << " µs\n";
+}
+
+// Árbol persistente frente al RB_tree mutable: coste de copiar el camino en cada
+// inserción y memoria extra de mantener vivo un snapshot mientras sigue escribiéndose
+void benchmark_persistent_rb(int N, const vector<int>& data, ofstream& csv, ofstream& memory_csv) {
+    // Bloque de make_shared: nodo + contadores y vptr del bloque de control (aprox.)
+    const size_t persistent_node_bytes = PersistentRBTree<int>::node_bytes + 16;
+
+    RB_tree<int> rb;
+    auto start = high_resolution_clock::now();
+    for (int v : data) rb.add_leaf(v);
+    auto end = high_resolution_clock::now();
+    double t_rb = duration_cast<duration<double, micro>>(end - start).count();
+
+    PersistentRBTree<int> prb;
+    start = high_resolution_clock::now();
+    for (int v : data) prb.add_leaf(v);
+    end = high_resolution_clock::now();
+    double t_prb = duration_cast<duration<double, micro>>(end - start).count();
+    size_t live_before = PersistentRBTree<int>::live_nodes();
+
+    // Con un snapshot vivo, N/10 actualizaciones más: cada una retiene su camino copiado
+    auto snap = prb.snapshot();
+    int updates = N / 10;
+    start = high_resolution_clock::now();
+    for (int i = 0; i < updates; ++i) {
+        prb.add_leaf(data[i]);
+        prb.delete_leaf(data[i]);
+    }
+    end = high_resolution_clock::now();
+    double t_updates = duration_cast<duration<double, micro>>(end - start).count();
+    size_t live_with_snapshot = PersistentRBTree<int>::live_nodes();
+
+    volatile size_t dummy = 0;
+    start = high_resolution_clock::now();
+    for (int v : snap) dummy = dummy + static_cast<size_t>(v);
+    end = high_resolution_clock::now();
+    double t_scan = duration_cast<duration<double, micro>>(end - start).count();
+
+    csv << N << ",RedBlackTree,insert_sequence," << t_rb << "\n";
+    csv << N << ",PersistentRBTree,insert_sequence," << t_prb << "\n";
+    csv << N << ",PersistentRBTree,update_with_snapshot," << t_updates << "\n";
+    csv << N << ",PersistentRBTree,snapshot_scan," << t_scan << "\n";
+    memory_csv << N << ",RedBlackTree_mutable," << RB_tree<int>::node_bytes << "," << rb.reserved_bytes() << "\n";
+    memory_csv << N << ",PersistentRBTree," << persistent_node_bytes << "," << live_before * persistent_node_bytes << "\n";
+    memory_csv << N << ",PersistentRBTree_snapshot," << persistent_node_bytes << ","
+               << live_with_snapshot * persistent_node_bytes << "\n";
+
+    cout << "  insert RB_tree: " << t_rb << " µs, persistente: " << t_prb << " µs\n"
+         << "  " << 2 * updates << " actualizaciones con snapshot vivo: " << t_updates << " µs, nodos retenidos: "
+         << (live_with_snapshot - live_before) << " ("
+         << (live_with_snapshot - live_before) / (2.0 * updates) << " por actualización)\n"
+         << "  memoria RB_tree: " << rb.reserved_bytes() / (1024.0 * 1024.0) << " MiB, persistente: "
+         << live_before * persistent_node_bytes / (1024.0 * 1024.0) << " MiB (aprox.)\n";
+}
+
+// Operaciones de conjuntos: bucle ingenuo de inserciones/búsquedas/borrados frente a
+// union_with/intersect_with/difference_with basadas en join (en serie y en paralelo).
+// Dos árboles de N claves cada uno con la mitad del rango en común; la carga de los
+// árboles no se cuenta.
+void benchmark_rb_set_operations(int N, mt19937& rng, ofstream& csv) {
+    uniform_int_distribution<int> key_dist(0, 4 * N);
+    vector<int> a_keys, b_keys;
+    a_keys.reserve(N);
+    b_keys.reserve(N);
+    for (int i = 0; i < N; ++i) {
+        a_keys.push_back(key_dist(rng));
+        b_keys.push_back(key_dist(rng) + 2 * N); // solapan en [2N, 4N]
+    }
+    sort(a_keys.begin(), a_keys.end());
+    a_keys.erase(unique(a_keys.begin(), a_keys.end()), a_keys.end());
+    sort(b_keys.begin(), b_keys.end());
+    b_keys.erase(unique(b_keys.begin(), b_keys.end()), b_keys.end());
+
+    auto time_op = [&](const string& operation, auto&& op) {
+        RB_tree<int> a(a_keys.begin(), a_keys.end());
+        RB_tree<int> b(b_keys.begin(), b_keys.end());
+        auto start = high_resolution_clock::now();
+        op(a, b);
+        auto end = high_resolution_clock::now();
+        double t = duration_cast<duration<double, micro>>(end - start).count();
+        csv << N << ",RedBlackTree," << operation << "," << t << "\n";
+        cout << "  " << operation << ": " << t << " µs (resultado " << a.size() << " claves)\n";
+    };
+
+    time_op("union_naive", [](RB_tree<int>& a, RB_tree<int>& b) {
+        for (int k : b) a.insert_unique(k);
+    });
+    time_op("union_join", [](RB_tree<int>& a, RB_tree<int>& b) { a.union_with(std::move(b)); });
+    time_op("union_join_par", [](RB_tree<int>& a, RB_tree<int>& b) { a.union_with(std::move(b), true); });
+
+    time_op("intersect_naive", [](RB_tree<int>& a, RB_tree<int>& b) {
+        RB_tree<int> result;
+        for (int k : a)
+            if (b.find(k)) result.add_leaf(k);
+        a = std::move(result);
+    });
+    time_op("intersect_join", [](RB_tree<int>& a, RB_tree<int>& b) { a.intersect_with(std::move(b)); });
+    time_op("intersect_join_par", [](RB_tree<int>& a, RB_tree<int>& b) { a.intersect_with(std::move(b), true); });
+
+    time_op("difference_naive", [](RB_tree<int>& a, RB_tree<int>& b) {
+        for (int k : b) a.delete_leaf(k);
+    });
+    time_op("difference_join", [](RB_tree<int>& a, RB_tree<int>& b) { a.difference_with(std::move(b)); });
+    time_op("difference_join_par", [](RB_tree<int>& a, RB_tree<int>& b) { a.difference_with(std::move(b), true); });
+}
+
+// Referencia: lo que se hacía hasta ahora, todo el acceso tras un único mutex
+struct MutexRBTree {
+    mutable mutex m;
+    RB_tree<int> tree;
+    MutexRBTree(vector<int>::const_iterator first, vector<int>::const_iterator last) : tree(first, last) {}
+    bool find(int key) const { lock_guard lock(m); return tree.find(key); }
+    void add_leaf(int key) { lock_guard lock(m); tree.add_leaf(key); }
+    bool delete_leaf(int key) { lock_guard lock(m); return tree.delete_leaf(key); }
+};
+
+// Escalabilidad de las lecturas: cada hilo lector hace QUERIES búsquedas mientras
+// un hilo escritor inserta y borra claves sin parar. Se mide el tiempo de pared
+// hasta que terminan todos los lectores: con escalado perfecto no crece con los hilos.
+template<typename Tree>
+void benchmark_concurrent_reads(int N, const string& structure, const vector<int>& data, ofstream& csv) {
+    const int QUERIES = 200000;
+    for (int threads : {1, 2, 4, 8}) {
+        Tree tree(data.cbegin(), data.cend());
+        atomic<bool> stop{false};
+        thread writer([&] {
+            mt19937 wrng(threads);
+            uniform_int_distribution<int> wdist(1, N * 10);
+            while (!stop.load(memory_order_relaxed)) {
+                int v = wdist(wrng);
+                tree.add_leaf(v);
+                tree.delete_leaf(v);
+            }
+        });
+
+        atomic<long> hits{0};
+        auto start = high_resolution_clock::now();
+        vector<thread> readers;
+        for (int t = 0; t < threads; ++t) {
+            readers.emplace_back([&, t] {
+                long local = 0;
+                for (int i = 0; i < QUERIES; ++i)
+                    local += tree.find(data[(static_cast<size_t>(i) * 7919 + t) % data.size()]) ? 1 : 0;
+                hits += local;
+            });
+        }
+        for (auto& r : readers) r.join();
+        auto end = high_resolution_clock::now();
+        stop = true;
+        writer.join();
+
+        double t = duration_cast<duration<double, micro>>(end - start).count();
+        csv << N << "," << structure << ",concurrent_find_t" << threads << "," << t << "\n";
+        cout << "  " << structure << " " << threads << " lectores: " << t << " µs ("
+             << (threads * static_cast<double>(QUERIES) / t) << " Mfind/s, aciertos " << hits << ")\n";
+    }
+}
+
+// Inserciones concurrentes: threads escritores se reparten las N claves de data.
+// Mide el tiempo hasta que terminan todos: con escalado perfecto baja con los hilos.
+template<typename Tree, typename Make>
+void benchmark_concurrent_inserts(int N, const string& structure, const vector<int>& data, ofstream& csv, Make make) {
+    for (int threads : {1, 2, 4, 8, 16}) {
+        unique_ptr<Tree> tree = make();
+        auto start = high_resolution_clock::now();
+        vector<thread> writers;
+        for (int t = 0; t < threads; ++t) {
+            writers.emplace_back([&, t] {
+                for (size_t i = t; i < data.size(); i += threads) tree->add_leaf(data[i]);
+            });
+        }
+        for (auto& w : writers) w.join();
+        auto end = high_resolution_clock::now();
+        if (tree->size() != data.size()) cerr << structure << ": faltan claves tras las inserciones\n";
+
+        double t = duration_cast<duration<double, micro>>(end - start).count();
+        csv << N << "," << structure << ",concurrent_insert_t" << threads << "," << t << "\n";
+        cout << "  " << structure << " " << threads << " escritores: " << t << " µs ("
+             << (static_cast<double>(N) / t) << " Minsert/s)\n";
+    }
+}
+
 int main() {
     const int NUM_ITERATIONS = 5;
     vector<int> Ns = {10, 100, 1000, 10000, 100000, 1000000};
@@ -29,7 +1064,8 @@ int main() {
 
         // ======== AVL ========
         {
-            vector<double> times_insert, times_search, times_erase;
+            vector<double> times_insert, times_search, times_search_batch, times_erase;
+            unique_ptr<bool[]> found(new bool[N]);
 
             for (int iter = 0; iter < NUM_ITERATIONS; ++iter) {
                 vector<int> data;
@@ -48,6 +1084,11 @@ int main() {
                 end = high_resolution_clock::now();
                 times_search.push_back(duration_cast<duration<double, micro>>(end - start).count());
 
+                start = high_resolution_clock::now();
+                avl.find_many(span<const int>(data), span<bool>(found.get(), N));
+                end = high_resolution_clock::now();
+                times_search_batch.push_back(duration_cast<duration<double, micro>>(end - start).count());
+
                 start = high_resolution_clock::now();
                 for (int v : data) avl.remove(v);
                 end = high_resolution_clock::now();
@@ -56,14 +1097,17 @@ int main() {
 
             double avg_insert = accumulate(times_insert.begin(), times_insert.end(), 0.0) / NUM_ITERATIONS;
             double avg_search = accumulate(times_search.begin(), times_search.end(), 0.0) / NUM_ITERATIONS;
+            double avg_search_batch = accumulate(times_search_batch.begin(), times_search_batch.end(), 0.0) / NUM_ITERATIONS;
             double avg_erase = accumulate(times_erase.begin(), times_erase.end(), 0.0) / NUM_ITERATIONS;
 
             csv << N << ",AVL,insert," << avg_insert << "\n";
             csv << N << ",AVL,search," << avg_search << "\n";
+            csv << N << ",AVL,search_batch," << avg_search_batch << "\n";
             csv << N << ",AVL,erase," << avg_erase << "\n";
 
             cout << "AVL → insert:" << avg_insert
                  << " search:" << avg_search
+                 << " search_batch:" << avg_search_batch
                  << " erase:" << avg_erase << " µs\n";
         }
 
@@ -106,45 +1150,260 @@ int main() {
                  << " erase:" << avg_erase << " µs\n";
         }
 
+        // ======== B+-tree (nodos de 256 bytes) ========
+        benchmark_btree<BTree<int>>("BTree", "B+-tree (256 B)", N, NUM_ITERATIONS, csv, rng, dist);
+
         // ======== Red-Black Tree ========
-        {
-            vector<double> times_insert, times_search, times_erase;
+        // Con slab_pool (por defecto) y con un new/delete por nodo, para medir el efecto del pool
+        benchmark_rb_tree<RB_tree<int>>("RedBlackTree", "Red-Black Tree", N, NUM_ITERATIONS, csv, rng, dist);
+        benchmark_rb_tree<RB_tree<int, less<int>, heap_pool>>("RedBlackTree_heap", "Red-Black Tree (new/delete)", N, NUM_ITERATIONS, csv, rng, dist);
 
-            for (int iter = 0; iter < NUM_ITERATIONS; ++iter) {
-                vector<int> data;
-                data.reserve(N);
-                for (int i = 0; i < N; ++i) data.push_back(dist(rng));
+        // ======== Índices congelados (solo lectura) ========
+        benchmark_frozen_index<FrozenIndex<int>>("Frozen_Eytzinger", "RB_tree::freeze (Eytzinger)", N, NUM_ITERATIONS, csv, rng, dist);
+        benchmark_frozen_index<FrozenBlockIndex<int>>("Frozen_Block", "RB_tree::freeze (S-tree)", N, NUM_ITERATIONS, csv, rng, dist);
+    }
 
-                RB_tree<int> rb;
-                auto start = high_resolution_clock::now();
-                for (int v : data) rb.add_leaf(v);
-                auto end = high_resolution_clock::now();
-                times_insert.push_back(duration_cast<duration<double, micro>>(end - start).count());
+    // ======== Tamaño de nodo del BTree ========
+    // De una línea de caché a dieciséis: más claves por nodo son menos niveles
+    // pero más claves que desplazar al insertar y borrar
+    {
+        const int N = 1000000;
+        cout << "\n===== Tamaño de nodo BTree, N = " << N << " =====\n";
+        benchmark_btree<BTree<int, less<int>, 64>>("BTree_64", "B+-tree (64 B)", N, NUM_ITERATIONS, csv, rng, dist);
+        benchmark_btree<BTree<int, less<int>, 128>>("BTree_128", "B+-tree (128 B)", N, NUM_ITERATIONS, csv, rng, dist);
+        benchmark_btree<BTree<int, less<int>, 256>>("BTree_256", "B+-tree (256 B)", N, NUM_ITERATIONS, csv, rng, dist);
+        benchmark_btree<BTree<int, less<int>, 512>>("BTree_512", "B+-tree (512 B)", N, NUM_ITERATIONS, csv, rng, dist);
+        benchmark_btree<BTree<int, less<int>, 1024>>("BTree_1024", "B+-tree (1024 B)", N, NUM_ITERATIONS, csv, rng, dist);
+    }
 
-                volatile int dummy3 = 0;
-                start = high_resolution_clock::now();
-                for (int v : data) dummy3 += rb.find(v) ? 1 : 0;
-                end = high_resolution_clock::now();
-                times_search.push_back(duration_cast<duration<double, micro>>(end - start).count());
+    // ======== Instrumentación (TreeStats.h) ========
+    {
+        ofstream stats_csv("stats_results.csv");
+        stats_csv << "N,Structure,Operation,Time_microseconds," << tree_stats::csv_columns() << "\n";
+        for (int N : {10000, 100000, 1000000}) {
+            cout << "\n===== Trabajo estructural por operación, N = " << N << " =====\n";
+            vector<int> data;
+            data.reserve(N);
+            for (int i = 0; i < N; ++i) data.push_back(dist(rng));
 
-                start = high_resolution_clock::now();
-                for (int v : data) rb.delete_leaf(v);
-                end = high_resolution_clock::now();
-                times_erase.push_back(duration_cast<duration<double, micro>>(end - start).count());
-            }
+            benchmark_tree_stats<RB_tree<int, less<int>, slab_pool, rb_pointer_layout, rb_no_augment, tree_stats>>(
+                N, "RedBlackTree", data, stats_csv,
+                [](auto& t, int v) { t.add_leaf(v); },
+                [](auto& t, int v) { volatile bool r = t.find(v); (void)r; },
+                [](auto& t, int v) { t.delete_leaf(v); });
+            benchmark_tree_stats<AVL<int, less<int>, slab_pool, tree_stats>>(
+                N, "AVL", data, stats_csv,
+                [](auto& t, int v) { t.insert(v); },
+                [](auto& t, int v) { volatile bool r = t.find(v); (void)r; },
+                [](auto& t, int v) { t.remove(v); });
+            benchmark_tree_stats<basic_splay_tree<less<int>, tree_stats>>(
+                N, "Splay", data, stats_csv,
+                [](auto& t, int v) { t.insert(v); },
+                [](auto& t, int v) { volatile int r = t.find(v); (void)r; },
+                [](auto& t, int v) { t.remove(v); });
+        }
+    }
 
-            double avg_insert = accumulate(times_insert.begin(), times_insert.end(), 0.0) / NUM_ITERATIONS;
-            double avg_search = accumulate(times_search.begin(), times_search.end(), 0.0) / NUM_ITERATIONS;
-            double avg_erase = accumulate(times_erase.begin(), times_erase.end(), 0.0) / NUM_ITERATIONS;
+    // ======== Layouts de nodo del RB_tree ========
+    ofstream memory_csv("memory_results.csv");
+    memory_csv << "N,Structure,Node_bytes,Reserved_bytes\n";
+    for (int N : {1000000, 10000000}) {
+        cout << "\n===== Layouts de nodo RB_tree, N = " << N << " =====\n";
+        vector<int> data;
+        data.reserve(N);
+        for (int i = 0; i < N; ++i) data.push_back(dist(rng));
 
-            csv << N << ",RedBlackTree,insert," << avg_insert << "\n";
-            csv << N << ",RedBlackTree,search," << avg_search << "\n";
-            csv << N << ",RedBlackTree,erase," << avg_erase << "\n";
+        benchmark_rb_layout<RB_tree<int>>("RedBlackTree", N, data, csv, memory_csv);
+        benchmark_rb_layout<RB_compact_tree<int>>("RedBlackTree_compact", N, data, csv, memory_csv);
+        benchmark_rb_layout<RB_index_tree<int>>("RedBlackTree_index32", N, data, csv, memory_csv);
+    }
 
-            cout << "Red-Black Tree → insert:" << avg_insert
-                 << " search:" << avg_search
-                 << " erase:" << avg_erase << " µs\n";
+    // ======== Nodo del AVL: altura frente a balance de 2 bits ========
+    for (int N : {1000000, 10000000}) {
+        cout << "\n===== AVL frente a CompactAVL, N = " << N << " =====\n";
+        vector<int> data;
+        data.reserve(N);
+        for (int i = 0; i < N; ++i) data.push_back(dist(rng));
+
+        benchmark_avl_layout<AVL<int>>("AVL", N, data, csv, memory_csv);
+        benchmark_avl_layout<CompactAVL<int>>("AVL_compact", N, data, csv, memory_csv);
+    }
+
+    // ======== Árbol persistente (snapshots) ========
+    for (int N : {100000, 1000000}) {
+        cout << "\n===== PersistentRBTree frente a RB_tree, N = " << N << " =====\n";
+        vector<int> data;
+        data.reserve(N);
+        for (int i = 0; i < N; ++i) data.push_back(dist(rng));
+        benchmark_persistent_rb(N, data, csv, memory_csv);
+    }
+    memory_csv.close();
+
+    // ======== Recorridos ordenados ========
+    for (int N : {10000, 100000, 1000000}) {
+        cout << "\n===== Recorrido ordenado RB_tree, N = " << N << " =====\n";
+        vector<int> data;
+        data.reserve(N);
+        for (int i = 0; i < N; ++i) data.push_back(dist(rng));
+        benchmark_rb_range_scan(N, data, csv);
+    }
+
+    // ======== Inserción sin duplicados ========
+    for (int N : {100000, 1000000}) {
+        cout << "\n===== Inserción sin duplicados RB_tree, N = " << N << " =====\n";
+        // Rango reducido para que haya muchos duplicados
+        uniform_int_distribution<int> dup_dist(1, N / 2);
+        vector<int> data;
+        vector<string> str_data;
+        data.reserve(N);
+        str_data.reserve(N);
+        for (int i = 0; i < N; ++i) {
+            data.push_back(dup_dist(rng));
+            str_data.push_back("clave_" + to_string(data.back()));
         }
+        benchmark_rb_insert_unique(N, "int", data, csv);
+        benchmark_rb_insert_unique(N, "string", str_data, csv);
+    }
+
+    // ======== Claves std::string: comparación de tres vías ========
+    for (int N : {100000, 1000000}) {
+        cout << "\n===== Claves std::string, N = " << N << " =====\n";
+        // Prefijo común largo: cada comparación recorre muchos caracteres
+        vector<string> data;
+        data.reserve(N);
+        for (int i = 0; i < N; ++i) data.push_back("registros/cliente/transaccion/" + to_string(dist(rng)));
+
+        auto rb_insert = [](auto& t, const string& v) { t.add_leaf(v); };
+        auto avl_insert = [](auto& t, const string& v) { t.insert(v); };
+        benchmark_string_keys<RB_tree<string>>(N, "RedBlackTree_string_3way", data, csv, rb_insert);
+        benchmark_string_keys<RB_tree<string, string_less_two_way>>(N, "RedBlackTree_string_2cmp", data, csv, rb_insert);
+        benchmark_string_keys<AVL<string>>(N, "AVL_string_3way", data, csv, avl_insert);
+        benchmark_string_keys<AVL<string, string_less_two_way>>(N, "AVL_string_2cmp", data, csv, avl_insert);
+    }
+
+    // ======== Estadísticos de orden ========
+    for (int N : {100000, 1000000}) {
+        cout << "\n===== Estadísticos de orden RB_tree, N = " << N << " =====\n";
+        vector<int> data;
+        data.reserve(N);
+        for (int i = 0; i < N; ++i) data.push_back(dist(rng));
+        benchmark_rb_order_statistics(N, data, csv);
+    }
+
+    // ======== Árbol de intervalos ========
+    for (int N : {100000, 1000000}) {
+        cout << "\n===== Consultas de intervalos RB_tree, N = " << N << " =====\n";
+        benchmark_rb_intervals(N, rng, csv);
+    }
+
+    // ======== Agregados por rango (monoide) ========
+    for (int N : {100000, 1000000}) {
+        cout << "\n===== Sumas por rango RB_aggregate_tree, N = " << N << " =====\n";
+        benchmark_rb_aggregate(N, rng, csv);
+    }
+
+    // ======== Borrado por rangos ========
+    for (int N : {100000, 1000000}) {
+        cout << "\n===== Borrado de claves antiguas RB_tree, N = " << N << " =====\n";
+        vector<int> data;
+        data.reserve(N);
+        for (int i = 0; i < N; ++i) data.push_back(dist(rng));
+        benchmark_rb_range_erase(N, data, csv);
+    }
+
+    // ======== Claves casi ordenadas (inserción por el extremo) ========
+    for (int N : {100000, 1000000}) {
+        cout << "\n===== Claves ordenadas y casi ordenadas, N = " << N << " =====\n";
+        benchmark_near_sorted(N, rng, csv);
+    }
+
+    // ======== Compactación tras churn (localidad de los nodos) ========
+    for (int N : {100000, 1000000}) {
+        cout << "\n===== Compactación RB_tree, N = " << N << " =====\n";
+        benchmark_rb_compaction(N, rng, csv);
+    }
+
+    // ======== AVL iterativo frente a recursivo ========
+    for (int N : {100000, 1000000}) {
+        cout << "\n===== AVL iterativo y recursivo, N = " << N << " =====\n";
+        vector<int> data;
+        data.reserve(N);
+        for (int i = 0; i < N; ++i) data.push_back(dist(rng));
+        benchmark_avl_iterative(N, data, csv);
+    }
+
+    // ======== Splay sin despacho virtual ========
+    for (int N : {10000, 100000, 1000000}) {
+        cout << "\n===== Splay: interfaz virtual frente a SplayTree, N = " << N << " =====\n";
+        vector<int> data;
+        data.reserve(N);
+        for (int i = 0; i < N; ++i) data.push_back(dist(rng));
+        benchmark_splay_dispatch(N, data, csv);
+    }
+
+    // ======== Carga masiva del RB_tree ========
+    for (int N : {100000, 1000000, 10000000}) {
+        cout << "\n===== Carga masiva RB_tree, N = " << N << " =====\n";
+        vector<int> data;
+        data.reserve(N);
+        for (int i = 0; i < N; ++i) data.push_back(dist(rng));
+        benchmark_rb_bulk_load(N, data, csv);
+    }
+
+    // ======== Arranque desde snapshot (save/load) ========
+    for (int N : {1000000, 10000000}) {
+        cout << "\n===== Snapshot binario RB_tree, N = " << N << " =====\n";
+        vector<int> data;
+        data.reserve(N);
+        for (int i = 0; i < N; ++i) data.push_back(dist(rng));
+        benchmark_rb_snapshot(N, data, csv);
+    }
+
+    // ======== Árbol en un archivo proyectado (mmap) ========
+    for (int N : {1000000, 10000000}) {
+        cout << "\n===== RB_tree en archivo proyectado, N = " << N << " =====\n";
+        vector<int> data;
+        data.reserve(N);
+        for (int i = 0; i < N; ++i) data.push_back(dist(rng));
+        benchmark_rb_mapped(N, data, csv);
+        remove("rb_mapped.bin");
+    }
+
+    // ======== Operaciones de conjuntos (join/split) ========
+    for (int N : {1000000, 10000000}) {
+        cout << "\n===== Unión, intersección y diferencia RB_tree, N = " << N << " =====\n";
+        benchmark_rb_set_operations(N, rng, csv);
+    }
+
+    // ======== Lecturas concurrentes ========
+    {
+        const int N = 1000000;
+        cout << "\n===== Lecturas concurrentes con un escritor, N = " << N
+             << " (" << thread::hardware_concurrency() << " hilos hardware) =====\n";
+        vector<int> data;
+        data.reserve(N);
+        for (int i = 0; i < N; ++i) data.push_back(dist(rng));
+        benchmark_concurrent_reads<MutexRBTree>(N, "RedBlackTree_mutex", data, csv);
+        benchmark_concurrent_reads<SharedLockRBTree<int>>(N, "RedBlackTree_shared_mutex", data, csv);
+        benchmark_concurrent_reads<ConcurrentRBTree<int>>(N, "RedBlackTree_optimistic", data, csv);
+    }
+
+    // ======== Escrituras concurrentes (shards por rango de clave) ========
+    {
+        const int N = 1000000;
+        cout << "\n===== Inserciones concurrentes, N = " << N
+             << " (" << thread::hardware_concurrency() << " hilos hardware) =====\n";
+        vector<int> data;
+        data.reserve(N);
+        for (int i = 0; i < N; ++i) data.push_back(dist(rng));
+        benchmark_concurrent_inserts<ConcurrentRBTree<int>>(N, "RedBlackTree_optimistic", data, csv,
+                                                            [] { return make_unique<ConcurrentRBTree<int>>(); });
+        // 64 shards (más que hilos) con separadores tomados de una muestra de 10000 claves
+        benchmark_concurrent_inserts<ShardedRBTree<int>>(N, "RedBlackTree_sharded", data, csv, [&] {
+            return make_unique<ShardedRBTree<int>>(64, data.begin(), data.begin() + 10000);
+        });
+        benchmark_concurrent_inserts<ShardedRBTree<int>>(N, "RedBlackTree_sharded_nosample", data, csv,
+                                                         [] { return make_unique<ShardedRBTree<int>>(64); });
     }
 
     csv.close();
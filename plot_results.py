@@ -15,6 +15,8 @@ except FileNotFoundError:
 traducciones_operaciones = {
     "insert": "Inserción",
     "search": "Búsqueda",
+    "search_batch": "Búsqueda por lotes",
+    "freeze": "Congelado (freeze)",
     "erase": "Eliminación"
 }
 
@@ -22,7 +24,8 @@ colores = {
     'std::set': '#1f77b4',
     'AVL': '#ff7f0e',
     'Splay': '#2ca02c',
-    'RedBlackTree': '#d62728'
+    'RedBlackTree': '#d62728',
+    'BTree': '#9467bd'
 }
 
 def plot_operation(df, operation):
@@ -58,10 +61,11 @@ def plot_operation(df, operation):
     plt.show()
 
 def plot_all_operations(df):
-    """Grafica las 3 operaciones lado a lado"""
-    operations = df["Operation"].unique()
+    """Grafica las operaciones lado a lado"""
+    operations = [op for op in ["insert", "search", "search_batch", "erase"] if op in df["Operation"].unique()]
 
-    fig, axes = plt.subplots(1, 3, figsize=(18, 6))
+    fig, axes = plt.subplots(1, len(operations), figsize=(6 * len(operations), 6), squeeze=False)
+    axes = axes[0]
     fig.suptitle('Comparación de Operaciones', fontsize=16, fontweight='bold')
 
     for idx, operation in enumerate(operations):
@@ -108,7 +112,7 @@ def create_comparison_table(df, N_value):
     print(f"{'Operación':<15} {'Estructura':<15} {'Tiempo [µs]':<15}")
     print(f"{'-'*70}")
 
-    for operation in ["insert", "search", "erase"]:
+    for operation in ["insert", "search", "search_batch", "erase"]:
         df_op = df_filtered[df_filtered["Operation"] == operation]
         op_traducida = traducciones_operaciones.get(operation, operation)
 